@@ -59,6 +59,44 @@ macro(set_lili_hdf5)
   find_package(HDF5 REQUIRED COMPONENTS C)
 endmacro()
 
+# Set the particle precision
+# double: double positions and velocities
+# mixed : double positions and float velocities
+# single: float positions and velocities
+macro(set_lili_particle_precision)
+  message(STATUS "Setting particle precision: ${LILI_PARTICLE_PRECISION}")
+
+  if(LILI_PARTICLE_PRECISION STREQUAL "double")
+    add_compile_definitions(__LILIP_REAL_X=double __LILIP_REAL_U=double)
+  elseif(LILI_PARTICLE_PRECISION STREQUAL "mixed")
+    add_compile_definitions(__LILIP_REAL_X=double __LILIP_REAL_U=float)
+  elseif(LILI_PARTICLE_PRECISION STREQUAL "single")
+    add_compile_definitions(__LILIP_REAL_X=float __LILIP_REAL_U=float)
+  else()
+    message(FATAL_ERROR
+      "Unknown LILI_PARTICLE_PRECISION: ${LILI_PARTICLE_PRECISION}")
+  endif()
+endmacro()
+
+# Set the SIMD instruction set
+# none  : compiler default, scalar field gathers
+# avx2  : AVX2 gathers
+# avx512: AVX-512 gathers
+# native: all of the instruction sets of the build machine
+macro(set_lili_simd)
+  message(STATUS "Setting SIMD instruction set: ${LILI_SIMD}")
+
+  if(LILI_SIMD STREQUAL "avx2")
+    add_compile_options(-mavx2)
+  elseif(LILI_SIMD STREQUAL "avx512")
+    add_compile_options(-mavx512f)
+  elseif(LILI_SIMD STREQUAL "native")
+    add_compile_options(-march=native)
+  elseif(NOT LILI_SIMD STREQUAL "none")
+    message(FATAL_ERROR "Unknown LILI_SIMD: ${LILI_SIMD}")
+  endif()
+endmacro()
+
 # Set the compiler flags
 macro(set_lili_compiler_flags)
   message(STATUS "Setting compiler flags")
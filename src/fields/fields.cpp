@@ -3,9 +3,198 @@
  * @brief Source file for additional routines of the Fields class
  */
 #include "fields.hpp"
+
+#include <algorithm>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 #include "mesh.hpp"
+#include "shape.hpp"
 
 namespace lili::mesh {
+void Fields::UpdateCache() {
+  const int ntx = ex.ntx();
+  const int nty = ex.nty();
+  const int ntz = ex.ntz();
+  const Mesh<double>* f[6] = {&ex, &ey, &ez, &bx, &by, &bz};
+
+  // Allocate the cache, the padding of each cell is zeroed
+  const std::size_t ncell = static_cast<std::size_t>(ntx) * nty * ntz;
+  cache_.Allocate(ncell * __LILIM_EB_STRIDE * sizeof(double));
+  double* cache = static_cast<double*>(cache_.data());
+  std::fill_n(cache, ncell * __LILIM_EB_STRIDE, 0.0);
+
+  // Interleave the components of each cell, ghost cells included
+  for (int k = 0; k < ntz; ++k) {
+    for (int j = 0; j < nty; ++j) {
+      double* row = cache + __LILIM_EB_STRIDE * (ntx * (j + nty * k));
+      for (int i = 0; i < ntx; ++i) {
+        for (int c = 0; c < 6; ++c) {
+          row[__LILIM_EB_STRIDE * i + c] =
+              (*f[c])(i - ex.ngx(), j - ex.ngy(), k - ex.ngz());
+        }
+      }
+    }
+  }
+}
+
+template <int Dim, int Order>
+void Fields::GatherEB(const double* x, const double* y, const double* z,
+                      int n, double* ex, double* ey, double* ez, double* bx,
+                      double* by, double* bz) const {
+  constexpr int W = Shape<Order>::width;
+  static_assert(Shape<Order>::ghost <= __LILIM_DEFAULT_NGHOST,
+                "Not enough ghost cells for the shape order");
+
+  // Origin and strides of each component and the matching output
+  const FieldsView<Dim> fv = View<Dim>();
+  const double* f[6] = {fv.ex.origin(), fv.ey.origin(), fv.ez.origin(),
+                        fv.bx.origin(), fv.by.origin(), fv.bz.origin()};
+  double* out[6] = {ex, ey, ez, bx, by, bz};
+  int sx = 1;
+  int sy = fv.ex.sy();
+  int sz = fv.ex.sz();
+
+  // Components next to each other in the interleaved cache
+  if (cached()) {
+    const int ntx = this->ex.ntx();
+    const int nty = this->ex.nty();
+    sx = __LILIM_EB_STRIDE;
+    sy = sx * ntx;
+    sz = sy * nty;
+
+    const double* origin =
+        static_cast<const double*>(cache_.data()) + sx * this->ex.ngx() +
+        sy * this->ex.ngy() + sz * this->ex.ngz();
+    for (int c = 0; c < 6; ++c) {
+      f[c] = origin + c;
+    }
+  }
+
+  int i = 0;
+  if constexpr (Dim == 2 && Order == 1) {
+// GCC flags the undefined source of the gather and conversion intrinsics
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+#if defined(__AVX512F__)
+    // Eight points at a time
+    const __m512d one = _mm512_set1_pd(1.0);
+    const __m256i vsx = _mm256_set1_epi32(sx);
+    const __m256i vsy = _mm256_set1_epi32(sy);
+    for (; i + 8 <= n; i += 8) {
+      const __m512d vx = _mm512_loadu_pd(x + i);
+      const __m512d vy = _mm512_loadu_pd(y + i);
+      const __m256i jx = _mm512_cvttpd_epi32(
+          _mm512_roundscale_pd(vx, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC));
+      const __m256i jy = _mm512_cvttpd_epi32(
+          _mm512_roundscale_pd(vy, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC));
+      const __m512d xd = _mm512_sub_pd(vx, _mm512_cvtepi32_pd(jx));
+      const __m512d yd = _mm512_sub_pd(vy, _mm512_cvtepi32_pd(jy));
+      const __m512d xm = _mm512_sub_pd(one, xd);
+      const __m512d ym = _mm512_sub_pd(one, yd);
+
+      // Cell corners
+      const __m256i i00 = _mm256_add_epi32(_mm256_mullo_epi32(jx, vsx),
+                                           _mm256_mullo_epi32(jy, vsy));
+      const __m256i i01 = _mm256_add_epi32(i00, vsy);
+      const __m256i i10 = _mm256_add_epi32(i00, vsx);
+      const __m256i i11 = _mm256_add_epi32(i01, vsx);
+
+      for (int c = 0; c < 6; ++c) {
+        const __m512d f00 = _mm512_i32gather_pd(i00, f[c], 8);
+        const __m512d f01 = _mm512_i32gather_pd(i01, f[c], 8);
+        const __m512d f10 = _mm512_i32gather_pd(i10, f[c], 8);
+        const __m512d f11 = _mm512_i32gather_pd(i11, f[c], 8);
+        const __m512d r0 = _mm512_add_pd(_mm512_mul_pd(ym, f00),
+                                         _mm512_mul_pd(yd, f01));
+        const __m512d r1 = _mm512_add_pd(_mm512_mul_pd(ym, f10),
+                                         _mm512_mul_pd(yd, f11));
+        _mm512_storeu_pd(out[c] + i, _mm512_add_pd(_mm512_mul_pd(xm, r0),
+                                                   _mm512_mul_pd(xd, r1)));
+      }
+    }
+#elif defined(__AVX2__)
+    // Four points at a time
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m128i vsx = _mm_set1_epi32(sx);
+    const __m128i vsy = _mm_set1_epi32(sy);
+    for (; i + 4 <= n; i += 4) {
+      const __m256d vx = _mm256_loadu_pd(x + i);
+      const __m256d vy = _mm256_loadu_pd(y + i);
+      const __m128i jx = _mm256_cvttpd_epi32(_mm256_floor_pd(vx));
+      const __m128i jy = _mm256_cvttpd_epi32(_mm256_floor_pd(vy));
+      const __m256d xd = _mm256_sub_pd(vx, _mm256_cvtepi32_pd(jx));
+      const __m256d yd = _mm256_sub_pd(vy, _mm256_cvtepi32_pd(jy));
+      const __m256d xm = _mm256_sub_pd(one, xd);
+      const __m256d ym = _mm256_sub_pd(one, yd);
+
+      // Cell corners
+      const __m128i i00 = _mm_add_epi32(_mm_mullo_epi32(jx, vsx),
+                                        _mm_mullo_epi32(jy, vsy));
+      const __m128i i01 = _mm_add_epi32(i00, vsy);
+      const __m128i i10 = _mm_add_epi32(i00, vsx);
+      const __m128i i11 = _mm_add_epi32(i01, vsx);
+
+      for (int c = 0; c < 6; ++c) {
+        const __m256d f00 = _mm256_i32gather_pd(f[c], i00, 8);
+        const __m256d f01 = _mm256_i32gather_pd(f[c], i01, 8);
+        const __m256d f10 = _mm256_i32gather_pd(f[c], i10, 8);
+        const __m256d f11 = _mm256_i32gather_pd(f[c], i11, 8);
+        const __m256d r0 = _mm256_add_pd(_mm256_mul_pd(ym, f00),
+                                         _mm256_mul_pd(yd, f01));
+        const __m256d r1 = _mm256_add_pd(_mm256_mul_pd(ym, f10),
+                                         _mm256_mul_pd(yd, f11));
+        _mm256_storeu_pd(out[c] + i, _mm256_add_pd(_mm256_mul_pd(xm, r0),
+                                                   _mm256_mul_pd(xd, r1)));
+      }
+    }
+#endif
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+  }
+
+  // Scalar loop
+  for (; i < n; ++i) {
+    // Stencil and weights, shared by the six components
+    double wx[W], wy[W], wz[W];
+    const int ix = Shape<Order>::Weights(x[i], wx);
+    int iy = 0, iz = 0;
+    if constexpr (Dim > 1) {
+      iy = Shape<Order>::Weights(y[i], wy);
+    }
+    if constexpr (Dim > 2) {
+      iz = Shape<Order>::Weights(z[i], wz);
+    }
+    const int i0 = sx * ix + sy * iy + sz * iz;
+
+    for (int c = 0; c < 6; ++c) {
+      out[c][i] =
+          ShapeInterpolation<Dim, W>(f[c] + i0, sx, sy, sz, wx, wy, wz);
+    }
+  }
+}
+
+// Explicit instantiation for each dimension and shape order
+#define __LILIM_GATHER_EB(Dim, Order)                                       \
+  template void Fields::GatherEB<Dim, Order>(                               \
+      const double*, const double*, const double*, int, double*, double*, \
+      double*, double*, double*, double*) const;
+#define __LILIM_GATHER_EB_ORDERS(Dim) \
+  __LILIM_GATHER_EB(Dim, 0)           \
+  __LILIM_GATHER_EB(Dim, 1)           \
+  __LILIM_GATHER_EB(Dim, 2)           \
+  __LILIM_GATHER_EB(Dim, 3)
+__LILIM_GATHER_EB_ORDERS(1)
+__LILIM_GATHER_EB_ORDERS(2)
+__LILIM_GATHER_EB_ORDERS(3)
+#undef __LILIM_GATHER_EB_ORDERS
+#undef __LILIM_GATHER_EB
+
 /**
  * @brief Function to load Fields data from a file
  * @param fields Fields data
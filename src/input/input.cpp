@@ -4,10 +4,12 @@
  */
 #include "input.hpp"
 
+#include <algorithm>
 #include <string>
 
 #include "json.hpp"
 #include "parameter.hpp"
+#include "shape.hpp"
 
 // Simplify namespace
 using json = nlohmann::ordered_json;
@@ -53,6 +55,18 @@ void InputParticles::Print() {
     lili::lout << p << " ";
   }
   lili::lout << std::endl;
+  lili::lout << "  Pos. layout : ";
+  switch (pos_layout) {
+    case PPosLayout::Physical:
+      lili::lout << "Physical" << std::endl;
+      break;
+    case PPosLayout::Cell:
+      lili::lout << "Cell" << std::endl;
+      break;
+    default:
+      lili::lout << "Unknown" << std::endl;
+      break;
+  }
   lili::lout << "  Vel. dist.  : ";
   switch (vel_dist) {
     case PVelDist::Maxwellian:
@@ -96,6 +110,7 @@ Input::Input(const Input& input) {
   mesh_ = input.mesh_;
   particles_ = input.particles_;
   loop_ = input.loop_;
+  compression_ = input.compression_;
 }
 
 void swap(Input& first, Input& second) {
@@ -110,6 +125,7 @@ void swap(Input& first, Input& second) {
   swap(first.mesh_, second.mesh_);
   swap(first.particles_, second.particles_);
   swap(first.loop_, second.loop_);
+  swap(first.compression_, second.compression_);
 }
 
 void Input::Parse() {
@@ -285,6 +301,20 @@ void Input::Parse() {
         }
       }
 
+      // Parse particle position layout
+      std::string playout_str = val.value("position_layout", "physical");
+      if (strcmp(playout_str.c_str(), "physical") == 0) {
+        species.pos_layout = PPosLayout::Physical;
+      } else if (strcmp(playout_str.c_str(), "cell") == 0) {
+        species.pos_layout = PPosLayout::Cell;
+      } else {
+        lili::lerr << "Unrecognized position layout: " << playout_str
+                   << std::endl;
+        lili::lerr << "Available position layout: [physical | cell]"
+                   << std::endl;
+        lili::output::LiliExit(2);
+      }
+
       // Parse particle velocity distribution
       if (val.contains("velocity_distribution")) {
         auto& vdist = val.at("velocity_distribution");
@@ -338,12 +368,76 @@ void Input::Parse() {
         InputLoopTask task;
         task.name = key;
         task.type = val.value("type", "none");
+        task.frequency = val.value("frequency", 1);
+        task.boundary = val.value("boundary", "periodic");
+        task.interleave = val.value("interleave", false);
+        task.collective = val.value("collective", false);
+        if (task.frequency < 1) {
+          lili::lerr << "Invalid frequency for task " << key << std::endl;
+          lili::output::LiliExit(2);
+        }
+        if (task.boundary != "periodic" && task.boundary != "label" &&
+            task.boundary != "absorb") {
+          lili::lerr << "Unrecognized boundary for task " << key << ": "
+                     << task.boundary << std::endl;
+          lili::lerr << "Available boundary: [periodic | label | absorb]"
+                     << std::endl;
+          lili::output::LiliExit(2);
+        }
+        const std::string shape = val.value("shape", "cic");
+        if (!mesh::StringToShapeOrder(shape, task.shape)) {
+          lili::lerr << "Unrecognized shape for task " << key << ": "
+                     << shape << std::endl;
+          lili::lerr << "Available shape: [ngp | cic | tsc | pqs]"
+                     << std::endl;
+          lili::output::LiliExit(2);
+        }
+
+        // Parse the particle tile size
+        if (val.contains("tile")) {
+          task.tile = val.at("tile").get<std::vector<int>>();
+          if (task.tile.size() != 3 ||
+              *std::min_element(task.tile.begin(), task.tile.end()) < 1) {
+            lili::lerr << "Invalid tile for task " << key
+                       << ", expected 3 positive cell counts" << std::endl;
+            lili::output::LiliExit(2);
+          }
+        }
+
+        // Parse the out-of-core chunk size and particle files
+        task.chunk = val.value("chunk", 0);
+        if (task.chunk < 0) {
+          lili::lerr << "Invalid chunk for task " << key << std::endl;
+          lili::output::LiliExit(2);
+        }
+        if (val.contains("files")) {
+          task.files =
+              val.at("files").get<std::map<std::string, std::string>>();
+        }
 
         // Add task to the list
         loop_.tasks.push_back(task);
       }
     }
   }
+
+  // Parse the output dataset compression
+  if (j.contains("output")) {
+    auto& j_output = j.at("output");
+    compression_.deflate = j_output.value("deflate", 0);
+    compression_.shuffle = j_output.value("shuffle", true);
+    const int chunk = j_output.value("chunk", __LILI_H5_CHUNK);
+    if (compression_.deflate < 0 || compression_.deflate > 9) {
+      lili::lerr << "Invalid output deflate level in " << input_file_
+                 << ", expected a level in [0, 9]" << std::endl;
+      lili::output::LiliExit(2);
+    }
+    if (chunk < 1) {
+      lili::lerr << "Invalid output chunk size in " << input_file_ << std::endl;
+      lili::output::LiliExit(2);
+    }
+    compression_.chunk = chunk;
+  }
 }
 
 Input ParseArguments(int argc, char** argv, lili::output::LiliCout& lout) {
@@ -6,11 +6,14 @@
 
 #include <fstream>
 #include <iostream>
+#include <map>
 #include <string>
 #include <vector>
 
 #include "mesh.hpp"
 #include "output.hpp"
+#include "output_hdf5.hpp"
+#include "shape.hpp"
 
 /**
  * @brief
@@ -35,6 +38,14 @@ enum class PPosDist {
   Uniform      ///< Uniform distribution
 };
 
+/**
+ * @brief Enumeration for particle position layout
+ */
+enum class PPosLayout {
+  Physical,  ///< Positions in the physical coordinate
+  Cell       ///< Cell index and in-cell offset in the grid unit
+};
+
 /**
  * @brief Enumeration for particle velocity distribution function
  */
@@ -72,6 +83,7 @@ class InputParticles {
 
     pos_dist = PPosDist::Stationary;
     pos_dist_param = {};
+    pos_layout = PPosLayout::Physical;
 
     vel_dist = PVelDist::Maxwellian;
     vel_dist_param = {};
@@ -96,6 +108,7 @@ class InputParticles {
   PPosDist pos_dist;  ///< Particle position distribution
   std::vector<double>
       pos_dist_param;  ///< Particle position distribution parameters
+  PPosLayout pos_layout;  ///< Particle position layout
   PVelDist vel_dist;   ///< Particle velocity distribution
   std::vector<double>
       vel_dist_param;  ///< Particle velocity distribution parameters
@@ -114,10 +127,26 @@ class InputLoopTask {
   InputLoopTask() {
     name = "";
     type = "";
+    frequency = 1;
+    tile = {};
+    boundary = "periodic";
+    chunk = 0;
+    files = {};
+    interleave = false;
+    shape = mesh::ShapeOrder::CIC;
+    collective = false;
   }
 
   std::string name;  ///< Task name
   std::string type;  ///< Task type
+  int frequency;     ///< Number of loop iterations between task executions
+  std::vector<int> tile;  ///< Number of cells per particle tile, if any
+  std::string boundary;   ///< Particle boundary policy
+  int chunk;  ///< Number of particles per out-of-core chunk, 0 for default
+  std::map<std::string, std::string> files;  ///< Particle file of each species
+  bool interleave;  ///< Whether to gather from the interleaved fields cache
+  mesh::ShapeOrder shape;  ///< Particle shape function
+  bool collective;    ///< Whether to write a single file for all ranks
 };
 
 /**
@@ -219,6 +248,7 @@ class Input {
   lili::mesh::MeshSize mesh() const { return mesh_; }
   std::vector<InputParticles> particles() const { return particles_; }
   InputLoop loop() const { return loop_; }
+  lili::output::H5Compression compression() const { return compression_; }
   /// @endcond
 
   // Setters
@@ -230,6 +260,7 @@ class Input {
   lili::mesh::MeshSize& mesh() { return mesh_; }
   std::vector<InputParticles>& particles() { return particles_; }
   InputLoop& loop() { return loop_; }
+  lili::output::H5Compression& compression() { return compression_; }
   /// @endcond
 
   /**
@@ -265,6 +296,18 @@ class Input {
     for (auto& t : loop_.tasks) {
       lout << "    Name      : " << t.name << std::endl;
       lout << "      Type    : " << t.type << std::endl;
+      lout << "      Freq.   : " << t.frequency << std::endl;
+      if (!t.tile.empty()) {
+        lout << "      Tile    : " << t.tile[0] << " " << t.tile[1] << " "
+             << t.tile[2] << std::endl;
+      }
+    }
+    if (compression_.deflate > 0) {
+      lout << "========== Output information ==========" << std::endl;
+      lout << "  deflate     : " << compression_.deflate << std::endl;
+      lout << "  shuffle     : " << (compression_.shuffle ? "true" : "false")
+           << std::endl;
+      lout << "  chunk       : " << compression_.chunk << std::endl;
     }
   }
 
@@ -278,6 +321,7 @@ class Input {
   lili::mesh::MeshSize mesh_;
   std::vector<InputParticles> particles_;
   InputLoop loop_;
+  lili::output::H5Compression compression_;
 };
 
 // Function declaration
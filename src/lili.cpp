@@ -14,6 +14,7 @@
 #include "ltask_pmove.hpp"
 #include "mesh.hpp"
 #include "output.hpp"
+#include "output_hdf5.hpp"
 #include "parameter.hpp"
 #include "particle.hpp"
 #include "task.hpp"
@@ -67,6 +68,9 @@ int main(int argc, char* argv[]) {
   // Print the input and input mesh information
   input.Print(lili::lout);
 
+  // Set the compression of the HDF5 output
+  lili::output::h5_compression = input.compression();
+
   MPI_Barrier(MPI_COMM_WORLD);
 
   // Set the number of loop iterations
@@ -0,0 +1,84 @@
+/**
+ * @file memory.cpp
+ * @brief Source file for the aligned memory arena
+ */
+#include "memory.hpp"
+
+#include <sys/mman.h>
+
+#include <cstdlib>
+#include <iostream>
+
+namespace lili::memory {
+void Arena::Allocate(std::size_t bytes) {
+  // Free the current block
+  Release();
+
+  // Nothing to allocate
+  if (bytes == 0) {
+    return;
+  }
+  bytes = AlignUp(bytes);
+
+  // Large blocks are mapped to be eligible for transparent hugepages
+  if (__LILI_HUGEPAGE_BSIZE > 0 && bytes >= __LILI_HUGEPAGE_BSIZE) {
+    void* ptr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ptr != MAP_FAILED) {
+#ifdef MADV_HUGEPAGE
+      madvise(ptr, bytes, MADV_HUGEPAGE);
+#endif
+      data_ = ptr;
+      bytes_ = bytes;
+      mapped_ = true;
+      return;
+    }
+  }
+
+  // Fall back to the aligned heap allocator
+  data_ = std::aligned_alloc(__LILI_ALIGNMENT, bytes);
+  if (data_ == nullptr) {
+    std::cerr << "Cannot allocate " << bytes << " bytes..." << std::endl;
+    exit(2);
+  }
+  bytes_ = bytes;
+  mapped_ = false;
+}
+
+bool Arena::Remap(std::size_t bytes) {
+#ifdef MREMAP_MAYMOVE
+  if (!mapped_ || bytes == 0) {
+    return false;
+  }
+  bytes = AlignUp(bytes);
+
+  void* ptr = mremap(data_, bytes_, bytes, MREMAP_MAYMOVE);
+  if (ptr == MAP_FAILED) {
+    return false;
+  }
+#ifdef MADV_HUGEPAGE
+  madvise(ptr, bytes, MADV_HUGEPAGE);
+#endif
+  data_ = ptr;
+  bytes_ = bytes;
+  return true;
+#else
+  (void)bytes;
+  return false;
+#endif
+}
+
+void Arena::Release() {
+  if (data_ != nullptr) {
+    if (mapped_) {
+      munmap(data_, bytes_);
+    } else {
+      std::free(data_);
+    }
+  }
+
+  data_ = nullptr;
+  bytes_ = 0;
+  mapped_ = false;
+}
+}  // namespace lili::memory
@@ -0,0 +1,128 @@
+/**
+ * @file memory.hpp
+ * @brief Header file for the aligned memory arena
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+#ifndef __LILI_ALIGNMENT
+/**
+ * @brief Default alignment in bytes for the memory arena
+ */
+#define __LILI_ALIGNMENT 64
+#endif
+
+#ifndef __LILI_HUGEPAGE_BSIZE
+/**
+ * @brief Minimum arena size in bytes to be backed by transparent hugepages
+ *
+ * @details
+ * Arenas at least this large are allocated through `mmap` and advised with
+ * `MADV_HUGEPAGE`. Set to 0 to always use the aligned heap allocator.
+ */
+#define __LILI_HUGEPAGE_BSIZE (1 << 21)
+#endif
+
+/**
+ * @brief Namespace for LILI memory management routines
+ */
+namespace lili::memory {
+/**
+ * @brief Round up the size to the next multiple of the alignment
+ *
+ * @param size Size to be rounded up
+ * @param alignment Alignment, must be a power of two
+ * @return std::size_t Rounded size
+ */
+constexpr std::size_t AlignUp(std::size_t size,
+                              std::size_t alignment = __LILI_ALIGNMENT) {
+  return (size + alignment - 1) & ~(alignment - 1);
+}
+
+/**
+ * @brief Class to own a single aligned memory block
+ *
+ * @details
+ * The Arena class owns one contiguous block of memory aligned to
+ * `__LILI_ALIGNMENT` bytes. Large blocks are allocated with `mmap` so that
+ * they can be backed by transparent hugepages, smaller blocks use
+ * `std::aligned_alloc`. The memory is not initialized.
+ *
+ * The class is move-only, the block is never duplicated implicitly.
+ */
+class Arena {
+ public:
+  // Constructor
+  Arena() : data_(nullptr), bytes_(0), mapped_(false) {}
+  Arena(std::size_t bytes) : Arena() { Allocate(bytes); }
+
+  // Copy constructor
+  Arena(const Arena& other) = delete;
+
+  // Move constructor
+  Arena(Arena&& other) noexcept : Arena() { swap(*this, other); }
+
+  // Destructor
+  ~Arena() { Release(); }
+
+  /**
+   * @brief Function to swap the data between two Arena objects
+   *
+   * @param first First Arena object
+   * @param second Second Arena object
+   */
+  friend void swap(Arena& first, Arena& second) noexcept {
+    using std::swap;
+    swap(first.data_, second.data_);
+    swap(first.bytes_, second.bytes_);
+    swap(first.mapped_, second.mapped_);
+  }
+
+  // Operators
+  /// @cond OPERATORS
+  Arena& operator=(Arena&& other) noexcept {
+    swap(*this, other);
+    return *this;
+  }
+  /// @endcond
+
+  // Getters
+  /// @cond GETTERS
+  constexpr void* data() const { return data_; };
+  constexpr std::size_t bytes() const { return bytes_; };
+  constexpr bool mapped() const { return mapped_; };
+  /// @endcond
+
+  /**
+   * @brief Allocate a new block, discarding the current one
+   *
+   * @param bytes Size of the block in bytes
+   */
+  void Allocate(std::size_t bytes);
+
+  /**
+   * @brief Resize the current block in place without copying the data
+   *
+   * @param bytes New size of the block in bytes
+   * @return bool Whether the block has been resized
+   * @details
+   * Only blocks allocated with `mmap` can be resized using `mremap`. The page
+   * mapping may move, but the content is preserved up to the smaller of the
+   * old and new sizes without copying it. Nothing is changed if the block
+   * cannot be remapped, the caller needs to allocate a new Arena instead.
+   */
+  bool Remap(std::size_t bytes);
+
+  /**
+   * @brief Free the current block
+   */
+  void Release();
+
+ private:
+  void* data_;         // Pointer to the data block
+  std::size_t bytes_;  // Size of the data block in bytes
+  bool mapped_;        // Whether the block is allocated using mmap
+};
+}  // namespace lili::memory
@@ -10,6 +10,7 @@
 
 #include "hdf5.h"
 #include "output.hpp"
+#include "output_hdf5.hpp"
 
 namespace lili::mesh {
 void PrintMeshSize(const MeshSize& mesh_size, lili::output::LiliCout& lout) {
@@ -31,6 +32,9 @@ void UpdateMeshSizeDim(MeshSize& mesh_size) {
 
 void SaveMesh(Mesh<double>& mesh, const char* file_name, const char* data_name,
               bool include_ghost) {
+  // Serialize the HDF5 calls with the other output routines
+  std::lock_guard<std::mutex> lock(lili::output::h5_mutex);
+
   // Check if file exists
   hid_t file_id;
   std::ifstream fs(file_name);
@@ -74,9 +78,11 @@ void SaveMesh(Mesh<double>& mesh, const char* file_name, const char* data_name,
   if (file_exists && H5Lexists(file_id, data_name, H5P_DEFAULT) > 0) {
     H5Ldelete(file_id, data_name, H5P_DEFAULT);
   }
+  hid_t dcpl_id = lili::output::H5DatasetCreatePlist(3, dims);
   hid_t dataset_id =
       H5Dcreate(file_id, data_name, H5T_NATIVE_DOUBLE, dataspace_id,
-                H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+                H5P_DEFAULT, dcpl_id, H5P_DEFAULT);
+  lili::output::H5ClosePlist(dcpl_id);
 
   // Prepare data to be written transpose it to row-major order
   double* data;
@@ -106,6 +112,9 @@ void SaveMesh(Mesh<double>& mesh, const char* file_name, const char* data_name,
 
 void LoadMeshTo(Mesh<double>& mesh, const char* file_name,
                 const char* data_name, bool include_ghost) {
+  // Serialize the HDF5 calls with the other output routines
+  std::lock_guard<std::mutex> lock(lili::output::h5_mutex);
+
   // Check if file exists
   hid_t file_id;
   std::ifstream fs(file_name);
@@ -7,7 +7,9 @@
 #include <algorithm>
 #include <cstdint>
 
+#include "memory.hpp"
 #include "output.hpp"
+#include "shape.hpp"
 
 #ifndef __LILIM_DEFAULT_NGHOST
 /**
@@ -16,6 +18,34 @@
 #define __LILIM_DEFAULT_NGHOST 2
 #endif
 
+static_assert(lili::mesh::ShapeGhost(lili::mesh::ShapeOrder::PQS) <=
+                  __LILIM_DEFAULT_NGHOST,
+              "The default ghost cells must fit every particle shape");
+
+#ifndef __LILIM_ROW_ALIGN
+/**
+ * @brief Alignment in bytes of each row of the mesh data
+ *
+ * @details
+ * The row pitch is padded to a multiple of this value so that every row
+ * starts at a SIMD aligned address. Set to the size of the data type to
+ * disable the padding.
+ */
+#define __LILIM_ROW_ALIGN __LILI_ALIGNMENT
+#endif
+
+#ifndef __LILIM_ROW_DEALIAS
+/**
+ * @brief Critical stride in bytes for the cache set aliasing of the rows
+ *
+ * @details
+ * A row pitch that is a multiple of this value is padded by one more
+ * `__LILIM_ROW_ALIGN` block, so that neighbouring rows of a stencil do not
+ * map to the same cache sets. Set to 0 to disable the de-aliasing.
+ */
+#define __LILIM_ROW_DEALIAS 4096
+#endif
+
 /**
  * @brief
  * Namespace for LILI mesh related routines
@@ -113,6 +143,103 @@ void PrintMeshSize(const MeshSize& mesh_size, lili::output::LiliCout& lout);
  */
 void UpdateMeshSizeDim(MeshSize& mesh_size);
 
+/**
+ * @brief Non-owning view of the Mesh data with a compile-time dimension
+ *
+ * @tparam T Data type
+ * @tparam Dim Dimension of the mesh, 1, 2, or 3
+ * @details
+ * The view stores the address of the first non-ghost cell and the strides of
+ * the Y and Z axes, so that the index arithmetic of the unused axes is
+ * removed at compile time. The accessors and the interpolation have no
+ * branch on the dimension and can be inlined in the particle loops. The view
+ * is obtained with Mesh::View and is invalidated when the Mesh is resized or
+ * destroyed.
+ */
+template <typename T, int Dim>
+class MeshView {
+  static_assert(Dim >= 1 && Dim <= 3, "Mesh dimension must be 1, 2, or 3");
+
+ public:
+  // Constructor
+  MeshView() : origin_(nullptr), sy_(0), sz_(0) {}
+
+  /**
+   * @brief Constructor for a view of a mesh data block
+   *
+   * @param data Pointer to the data block, including the ghost cells
+   * @param ngx Number of ghost cells in the X-axis
+   * @param ngy Number of ghost cells in the Y-axis
+   * @param ngz Number of ghost cells in the Z-axis
+   * @param px Row pitch of the data block
+   * @param nty Total number of rows in the Y-axis
+   */
+  MeshView(T* data, int ngx, int ngy, int ngz, int px, int nty)
+      : origin_(data + ngx + px * (ngy + nty * ngz)),
+        sy_(px),
+        sz_(px * nty) {}
+
+  // Getters
+  /// @cond GETTERS
+  static constexpr int dim() { return Dim; };
+  constexpr T* origin() const { return origin_; };
+  constexpr int sy() const { return sy_; };
+  constexpr int sz() const { return sz_; };
+  /// @endcond
+
+  // Operators
+  /// @cond OPERATORS
+  T& operator()(int i, int j = 0, int k = 0) const {
+    if constexpr (Dim == 1) {
+      return origin_[i];
+    } else if constexpr (Dim == 2) {
+      return origin_[i + sy_ * j];
+    } else {
+      return origin_[i + sy_ * j + sz_ * k];
+    }
+  };
+  /// @endcond
+
+  /**
+   * @brief Interpolation in the dimension of the view
+   *
+   * @tparam Order Order of the shape function, 1 (CIC) by default
+   * @param x Data point location relative to the mesh \f$x^\prime\f$
+   * @param y Data point location relative to the mesh \f$y^\prime\f$
+   * @param z Data point location relative to the mesh \f$z^\prime\f$
+   * @return Interpolated value at \f$(x^\prime, y^\prime, z^\prime)\f$
+   * @details
+   * Weighting with Shape, selected at compile time. The CIC order is the
+   * linear, bilinear, or trilinear interpolation of Mesh. The extra arguments
+   * are ignored in lower dimension.
+   */
+  template <int Order = 1>
+  T Interpolation(double x, double y = 0.0, double z = 0.0) const {
+    constexpr int W = Shape<Order>::width;
+    static_assert(Shape<Order>::ghost <= __LILIM_DEFAULT_NGHOST,
+                  "Not enough ghost cells for the shape order");
+
+    // Stencil weights of each axis
+    double wx[W], wy[W], wz[W];
+    const int ix = Shape<Order>::Weights(x, wx);
+    int iy = 0, iz = 0;
+    if constexpr (Dim > 1) {
+      iy = Shape<Order>::Weights(y, wy);
+    }
+    if constexpr (Dim > 2) {
+      iz = Shape<Order>::Weights(z, wz);
+    }
+
+    return ShapeInterpolation<Dim, W>(&(*this)(ix, iy, iz), 1, sy_, sz_, wx,
+                                      wy, wz);
+  };
+
+ private:
+  T* origin_;  // Pointer to the first non-ghost cell
+  int sy_;     // Stride of the Y-axis
+  int sz_;     // Stride of the Z-axis
+};
+
 /**
  * @brief Mesh class
  *
@@ -120,6 +247,12 @@ void UpdateMeshSizeDim(MeshSize& mesh_size);
  * @details
  * Base mesh class with ghost cells and smart access operator.
  * Data is stored in a 1D array with column-major ordering.
+ *
+ * The data block is a `__LILI_ALIGNMENT` aligned memory::Arena. Each row
+ * along the X-axis is stored with a pitch of px() elements, at least ntx(),
+ * given by RowPitch, so that every row is `__LILIM_ROW_ALIGN` aligned. The
+ * padding at the end of the rows is never part of the mesh, and nt() is the
+ * size of the data block including the padding.
  */
 template <typename T>
 class Mesh {
@@ -138,6 +271,11 @@ class Mesh {
         ngx_(0),
         ngy_(0),
         ngz_(0),
+        ntx_(0),
+        nty_(0),
+        ntz_(0),
+        nt_(0),
+        px_(0),
         data_(nullptr) {}
 
   // Size-based initialization
@@ -308,11 +446,7 @@ class Mesh {
   /**
    * @brief Destructor for the Mesh class
    */
-  ~Mesh() {
-    if (data_ != nullptr) {
-      delete[] data_;
-    }
-  }
+  ~Mesh() = default;
 
   /**
    * @brief Function to swap the data between two Mesh objects
@@ -335,7 +469,9 @@ class Mesh {
     swap(first.ntx_, second.ntx_);
     swap(first.nty_, second.nty_);
     swap(first.ntz_, second.ntz_);
+    swap(first.px_, second.px_);
     swap(first.nt_, second.nt_);
+    swap(first.arena_, second.arena_);
     swap(first.data_, second.data_);
   }
 
@@ -351,10 +487,22 @@ class Mesh {
   constexpr int ntx() const { return ntx_; };
   constexpr int nty() const { return nty_; };
   constexpr int ntz() const { return ntz_; };
+  constexpr int px() const { return px_; };
   constexpr int nt() const { return nt_; };
   constexpr T* data() const { return data_; };
   /// @endcond
 
+  /**
+   * @brief View of the mesh with a compile-time dimension
+   *
+   * @tparam Dim Dimension of the view
+   * @return MeshView<T, Dim> View of the mesh data
+   */
+  template <int Dim>
+  MeshView<T, Dim> View() const {
+    return MeshView<T, Dim>(data_, ngx_, ngy_, ngz_, px_, nty_);
+  };
+
   // Operators
   /// @cond OPERATORS
   /**
@@ -402,13 +550,32 @@ class Mesh {
 
   // Smart access operator (3D)
   T operator()(int i, int j, int k) const {
-    return data_[ngx_ + i + ntx_ * (ngy_ + j + nty_ * (ngz_ + k))];
+    return data_[ngx_ + i + px_ * (ngy_ + j + nty_ * (ngz_ + k))];
   };
   T& operator()(int i, int j, int k) {
-    return data_[ngx_ + i + ntx_ * (ngy_ + j + nty_ * (ngz_ + k))];
+    return data_[ngx_ + i + px_ * (ngy_ + j + nty_ * (ngz_ + k))];
   };
   /// @endcond
 
+  /**
+   * @brief Row pitch of the mesh data for a given row length
+   *
+   * @param ntx Number of elements in a row, including the ghost cells
+   * @return int Number of elements between the start of consecutive rows
+   * @details
+   * The row is padded to a multiple of `__LILIM_ROW_ALIGN` bytes, then by one
+   * more block if the padded row is a multiple of `__LILIM_ROW_DEALIAS` bytes.
+   */
+  static constexpr int RowPitch(int ntx) {
+    constexpr std::size_t align = std::max<std::size_t>(
+        memory::AlignUp(__LILIM_ROW_ALIGN, sizeof(T)), sizeof(T));
+    std::size_t bytes = memory::AlignUp(ntx * sizeof(T), align);
+    if (__LILIM_ROW_DEALIAS > 0 && bytes % __LILIM_ROW_DEALIAS == 0) {
+      bytes += align;
+    }
+    return bytes / sizeof(T);
+  }
+
   /**
    * @brief Recalculate the total mesh sizes based on the current sizes
    */
@@ -419,7 +586,8 @@ class Mesh {
     nty_ = ny_ + 2 * ngy_;
     ntz_ = nz_ + 2 * ngz_;
 
-    nt_ = ntx_ * nty_ * ntz_;
+    px_ = RowPitch(ntx_);
+    nt_ = px_ * nty_ * ntz_;
   };
 
   /**
@@ -439,13 +607,8 @@ class Mesh {
     // Update total mesh sizes
     UpdateTotalSizes();
 
-    // Check if the data is already allocated
-    if (data_ != nullptr) {
-      delete[] data_;
-    }
-
-    // Allocate memory
-    data_ = new T[nt_]();
+    // Allocate the aligned memory and zero it
+    AllocateData();
   };
 
   /**
@@ -495,10 +658,7 @@ class Mesh {
 
     // Reallocate memory if needed
     if (size_changed) {
-      if (data_ != nullptr) {
-        delete[] data_;
-      }
-      data_ = new T[nt_]();
+      AllocateData();
     }
   };
 
@@ -666,12 +826,7 @@ class Mesh {
    * @return Interpolated value at \f$x^\prime\f$
    */
   T LinearInterpolation(double x) const {
-    // Cache variables
-    int ix = static_cast<int>(x);
-    double xd = x - ix;
-
-    // Interpolate
-    return (1.0 - xd) * (*this)(ix, 0, 0) + xd * (*this)(ix + 1, 0, 0);
+    return View<1>().Interpolation(x);
   };
 
   /**
@@ -682,18 +837,7 @@ class Mesh {
    * @return Interpolated value at \f$(x^\prime, y^\prime)\f$
    */
   T BilinearInterpolation(double x, double y) const {
-    // Cache variables
-    int ix = static_cast<int>(x);
-    int iy = static_cast<int>(y);
-
-    double xd = x - ix;
-    double yd = y - iy;
-
-    // Interpolate
-    return (1.0 - xd) *
-               ((1.0 - yd) * (*this)(ix, iy, 0) + yd * (*this)(ix, iy + 1, 0)) +
-           xd * ((1.0 - yd) * (*this)(ix + 1, iy, 0) +
-                 yd * (*this)(ix + 1, iy + 1, 0));
+    return View<2>().Interpolation(x, y);
   }
 
   /**
@@ -705,24 +849,7 @@ class Mesh {
    * @return Interpolated value at \f$(x^\prime, y^\prime, z^\prime)\f$
    */
   T TrilinearInterpolation(double x, double y, double z) const {
-    // Cache variables
-    int ix = static_cast<int>(x);
-    int iy = static_cast<int>(y);
-    int iz = static_cast<int>(z);
-
-    double xd = x - ix;
-    double yd = y - iy;
-    double zd = z - iz;
-
-    // Interpolate
-    return (1.0 - xd) * ((1.0 - yd) * ((1.0 - zd) * (*this)(ix, iy, iz) +
-                                       zd * (*this)(ix, iy, iz + 1)) +
-                         yd * ((1.0 - zd) * (*this)(ix, iy + 1, iz) +
-                               zd * (*this)(ix, iy + 1, iz + 1))) +
-           xd * ((1.0 - yd) * ((1.0 - zd) * (*this)(ix + 1, iy, iz) +
-                               zd * (*this)(ix + 1, iy, iz + 1)) +
-                 yd * ((1.0 - zd) * (*this)(ix + 1, iy + 1, iz) +
-                       zd * (*this)(ix + 1, iy + 1, iz + 1)));
+    return View<3>().Interpolation(x, y, z);
   };
 
   /**
@@ -735,7 +862,8 @@ class Mesh {
    * @details
    * This function will automatically choose the interpolation method based on
    * the mesh dimension. Ignore the extra arguments if the mesh is in lower
-   * dimension.
+   * dimension. Inside particle loops, use the MeshView from View instead to
+   * select the dimension at compile time.
    */
   T Interpolation(double x, double y, double z) const {
     if (dim_ == 2) {
@@ -752,8 +880,19 @@ class Mesh {
   int nx_, ny_, nz_;          // Mesh sizes
   int ngx_, ngy_, ngz_;       // Ghost cells sizes (same for before and after)
   int ntx_, nty_, ntz_, nt_;  // Total mesh sizes (including ghost cells)
+  int px_;                    // Row pitch (including the padding)
+
+  memory::Arena arena_;  // Aligned memory block
+  T* data_;              // Pointer to the data block
 
-  T* data_;  // Pointer to the data block
+  /**
+   * @brief Allocate a zeroed data block of nt() elements
+   */
+  void AllocateData() {
+    arena_.Allocate(nt_ * sizeof(T));
+    data_ = static_cast<T*>(arena_.data());
+    std::fill_n(data_, nt_, T());
+  };
 };
 
 /**
@@ -770,6 +909,9 @@ class Mesh {
  * This function will save the Mesh data to a single HDF5 file. The data will be
  * saved in a dataset with the given name. If the file exists, the dataset will
  * be overwritten.
+ *
+ * Only the cells of the mesh are written, the row padding of the data block is
+ * skipped.
  */
 void SaveMesh(Mesh<double>& mesh, const char* file_name, const char* data_name,
               bool include_ghost = false);
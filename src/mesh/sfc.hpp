@@ -0,0 +1,243 @@
+/**
+ * @file sfc.hpp
+ * @brief Header only library for the space-filling curve cell ordering
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lili::mesh {
+/**
+ * @brief Enumeration class for the cell ordering
+ */
+enum class CellOrder {
+  RowMajor,  ///< Same ordering as the Mesh data \f$ i + n_x (j + n_y k) \f$
+  Morton,    ///< Morton (Z-order) curve
+  Hilbert    ///< Hilbert curve
+};
+
+/**
+ * @brief Spread the lower 32 bits of an integer to every other bit
+ *
+ * @param a Integer to spread
+ * @return uint64_t Spread integer
+ */
+constexpr uint64_t SpreadBits2(uint64_t a) {
+  a &= 0x00000000ffffffff;
+  a = (a | (a << 16)) & 0x0000ffff0000ffff;
+  a = (a | (a << 8)) & 0x00ff00ff00ff00ff;
+  a = (a | (a << 4)) & 0x0f0f0f0f0f0f0f0f;
+  a = (a | (a << 2)) & 0x3333333333333333;
+  a = (a | (a << 1)) & 0x5555555555555555;
+  return a;
+}
+
+/**
+ * @brief Spread the lower 21 bits of an integer to every third bit
+ *
+ * @param a Integer to spread
+ * @return uint64_t Spread integer
+ */
+constexpr uint64_t SpreadBits3(uint64_t a) {
+  a &= 0x00000000001fffff;
+  a = (a | (a << 32)) & 0x001f00000000ffff;
+  a = (a | (a << 16)) & 0x001f0000ff0000ff;
+  a = (a | (a << 8)) & 0x100f00f00f00f00f;
+  a = (a | (a << 4)) & 0x10c30c30c30c30c3;
+  a = (a | (a << 2)) & 0x1249249249249249;
+  return a;
+}
+
+/**
+ * @brief Morton key of a 2D cell index
+ *
+ * @param i X-axis cell index
+ * @param j Y-axis cell index
+ * @return uint64_t Morton key
+ */
+constexpr uint64_t MortonKey(uint32_t i, uint32_t j) {
+  return SpreadBits2(i) | (SpreadBits2(j) << 1);
+}
+
+/**
+ * @brief Morton key of a 3D cell index
+ *
+ * @param i X-axis cell index, up to 21 bits
+ * @param j Y-axis cell index, up to 21 bits
+ * @param k Z-axis cell index, up to 21 bits
+ * @return uint64_t Morton key
+ */
+constexpr uint64_t MortonKey(uint32_t i, uint32_t j, uint32_t k) {
+  return SpreadBits3(i) | (SpreadBits3(j) << 1) | (SpreadBits3(k) << 2);
+}
+
+/**
+ * @brief Hilbert key of a cell index
+ *
+ * @tparam D Number of dimensions
+ * @param idx Cell index in each axis
+ * @param nbit Number of bits per axis, \f$ 2^{n_\mathrm{bit}} \f$ should cover
+ * the largest mesh size
+ * @return uint64_t Hilbert key
+ * @details
+ * Transform the axes to the transposed Hilbert index using the algorithm of
+ * J. Skilling (AIP Conf. Proc. 707, 381, 2004), then interleave the bits of
+ * the transposed index.
+ */
+template <int D>
+constexpr uint64_t HilbertKey(const uint32_t (&idx)[D], int nbit) {
+  uint32_t x[D] = {};
+  for (int d = 0; d < D; ++d) {
+    x[d] = idx[d];
+  }
+
+  // Inverse undo
+  const uint32_t m = uint32_t(1) << (nbit - 1);
+  for (uint32_t q = m; q > 1; q >>= 1) {
+    const uint32_t p = q - 1;
+    for (int d = 0; d < D; ++d) {
+      if (x[d] & q) {
+        x[0] ^= p;
+      } else {
+        const uint32_t t = (x[0] ^ x[d]) & p;
+        x[0] ^= t;
+        x[d] ^= t;
+      }
+    }
+  }
+
+  // Gray encode
+  for (int d = 1; d < D; ++d) {
+    x[d] ^= x[d - 1];
+  }
+  uint32_t t = 0;
+  for (uint32_t q = m; q > 1; q >>= 1) {
+    if (x[D - 1] & q) {
+      t ^= q - 1;
+    }
+  }
+  for (int d = 0; d < D; ++d) {
+    x[d] ^= t;
+  }
+
+  // Interleave the transposed index
+  uint64_t key = 0;
+  for (int b = nbit - 1; b >= 0; --b) {
+    for (int d = 0; d < D; ++d) {
+      key = (key << 1) | ((x[d] >> b) & 1);
+    }
+  }
+  return key;
+}
+
+/**
+ * @brief Number of bits needed to index the given number of cells
+ *
+ * @param n Number of cells
+ * @return int Number of bits, at least 1
+ */
+constexpr int CellOrderBits(int n) {
+  int nbit = 1;
+  while ((1 << nbit) < n) {
+    ++nbit;
+  }
+  return nbit;
+}
+
+/**
+ * @brief Ordering key of a cell index
+ *
+ * @param order Cell ordering
+ * @param i X-axis cell index
+ * @param j Y-axis cell index
+ * @param k Z-axis cell index
+ * @param nx Number of cells in the X-axis
+ * @param ny Number of cells in the Y-axis
+ * @param nz Number of cells in the Z-axis
+ * @return uint64_t Ordering key
+ * @details
+ * The key can be used to sort anything that is associated with a cell, e.g.
+ * particles, mesh blocks, or domains. Lower dimensions are detected from the
+ * number of cells.
+ */
+constexpr uint64_t CellOrderKey(CellOrder order, int i, int j, int k, int nx,
+                                int ny, int nz) {
+  switch (order) {
+    case CellOrder::Morton:
+      if (nz > 1) {
+        return MortonKey(i, j, k);
+      }
+      return MortonKey(i, j);
+    case CellOrder::Hilbert:
+      if (nz > 1) {
+        const uint32_t idx[3] = {static_cast<uint32_t>(i),
+                                 static_cast<uint32_t>(j),
+                                 static_cast<uint32_t>(k)};
+        return HilbertKey<3>(idx, CellOrderBits(std::max({nx, ny, nz})));
+      } else if (ny > 1) {
+        const uint32_t idx[2] = {static_cast<uint32_t>(i),
+                                 static_cast<uint32_t>(j)};
+        return HilbertKey<2>(idx, CellOrderBits(std::max(nx, ny)));
+      }
+      return i;
+    default:
+      return i +
+             static_cast<uint64_t>(nx) * (j + static_cast<uint64_t>(ny) * k);
+  }
+}
+
+/**
+ * @brief Function to convert a string to CellOrder
+ *
+ * @param[in] order String representation of the cell ordering
+ * @param[out] cell_order Cell ordering
+ * @return bool Whether the string is a valid cell ordering
+ */
+inline bool StringToCellOrder(const std::string& order, CellOrder& cell_order) {
+  if (order == "cell" || order == "row_major") {
+    cell_order = CellOrder::RowMajor;
+  } else if (order == "morton") {
+    cell_order = CellOrder::Morton;
+  } else if (order == "hilbert") {
+    cell_order = CellOrder::Hilbert;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Function to list cell blocks following the given cell ordering
+ *
+ * @param order Cell ordering
+ * @param nbx Number of blocks in the X-axis
+ * @param nby Number of blocks in the Y-axis
+ * @param nbz Number of blocks in the Z-axis
+ * @return std::vector<int> Row-major block index \f$ i + n_x (j + n_y k) \f$
+ * of each block in the traversal order
+ * @details
+ * This is useful to traverse blocks of a Mesh (e.g. tiles or sub-domains) in
+ * a cache or locality friendly order while keeping the Mesh data layout.
+ */
+inline std::vector<int> CellOrderBlocks(CellOrder order, int nbx, int nby,
+                                        int nbz) {
+  const int nb = nbx * nby * nbz;
+  std::vector<uint64_t> key(nb);
+  std::vector<int> blocks(nb);
+  for (int k = 0; k < nbz; ++k) {
+    for (int j = 0; j < nby; ++j) {
+      for (int i = 0; i < nbx; ++i) {
+        const int ib = i + nbx * (j + nby * k);
+        key[ib] = CellOrderKey(order, i, j, k, nbx, nby, nbz);
+        blocks[ib] = ib;
+      }
+    }
+  }
+  std::stable_sort(blocks.begin(), blocks.end(),
+                   [&key](int a, int b) { return key[a] < key[b]; });
+  return blocks;
+}
+}  // namespace lili::mesh
@@ -0,0 +1,169 @@
+/**
+ * @file shape.hpp
+ * @brief Header only library for the particle shape functions
+ */
+#pragma once
+
+#include <cmath>
+#include <string>
+
+namespace lili::mesh {
+/**
+ * @brief Enumeration class for the order of the particle shape function
+ */
+enum class ShapeOrder {
+  NGP = 0,  ///< Nearest grid point
+  CIC = 1,  ///< Cloud in cell, linear weighting
+  TSC = 2,  ///< Triangular shaped cloud, quadratic weighting
+  PQS = 3   ///< Cubic spline weighting
+};
+
+/**
+ * @brief Function to convert a string to ShapeOrder
+ *
+ * @param[in] shape String representation of the shape function
+ * @param[out] shape_order Order of the shape function
+ * @return bool Whether the string is a valid shape function
+ */
+inline bool StringToShapeOrder(const std::string& shape,
+                               ShapeOrder& shape_order) {
+  if (shape == "ngp") {
+    shape_order = ShapeOrder::NGP;
+  } else if (shape == "cic") {
+    shape_order = ShapeOrder::CIC;
+  } else if (shape == "tsc") {
+    shape_order = ShapeOrder::TSC;
+  } else if (shape == "pqs") {
+    shape_order = ShapeOrder::PQS;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Number of ghost cells needed by a shape function
+ *
+ * @param order Order of the shape function
+ * @return int Number of ghost cells on each side of an axis
+ * @details
+ * For a point \f$ x \in [0, n) \f$, the stencil of NGP and CIC reaches the
+ * node \f$ n \f$, while TSC and PQS reach the nodes \f$ -1 \f$ and
+ * \f$ n + 1 \f$.
+ */
+constexpr int ShapeGhost(ShapeOrder order) {
+  return (static_cast<int>(order) + 2) / 2;
+}
+
+/**
+ * @brief Particle shape function with a compile-time order
+ *
+ * @tparam Order Order of the shape function, 0 (NGP) to 3 (PQS)
+ * @details
+ * The shape function is the B-spline of the given order. The weights of the
+ * `width` nodes of the stencil are computed once for each axis of a point,
+ * and shared by all of the interpolated components.
+ */
+template <int Order>
+struct Shape {
+  static_assert(Order >= 0 && Order <= 3, "Shape order must be 0 to 3");
+
+  /**
+   * @brief Number of nodes of the stencil along each axis
+   */
+  static constexpr int width = Order + 1;
+
+  /**
+   * @brief Number of ghost cells needed on each side of an axis
+   */
+  static constexpr int ghost = ShapeGhost(static_cast<ShapeOrder>(Order));
+
+  /**
+   * @brief Stencil weights of a point along one axis
+   *
+   * @param[in] x Point location relative to the mesh \f$x^\prime \ge 0\f$
+   * @param[out] w Weights of the `width` nodes of the stencil
+   * @return int Index of the first node of the stencil
+   * @details
+   * The node index is rounded down with `std::floor`, so that a point
+   * slightly below zero, e.g. in the ghost cells, gets the stencil of its
+   * own cell. The CIC weights are the ones of MeshView::Interpolation.
+   */
+  static int Weights(double x, double* w) {
+    if constexpr (Order == 0) {
+      w[0] = 1.0;
+      return static_cast<int>(std::floor(x + 0.5));
+    } else if constexpr (Order == 1) {
+      const int i = static_cast<int>(std::floor(x));
+      const double d = x - i;
+      w[0] = 1.0 - d;
+      w[1] = d;
+      return i;
+    } else if constexpr (Order == 2) {
+      // Offset from the nearest node, in [-0.5, 0.5)
+      const int i = static_cast<int>(std::floor(x + 0.5));
+      const double d = x - i;
+      w[0] = 0.5 * (0.5 - d) * (0.5 - d);
+      w[1] = 0.75 - d * d;
+      w[2] = 0.5 * (0.5 + d) * (0.5 + d);
+      return i - 1;
+    } else {
+      const int i = static_cast<int>(std::floor(x));
+      const double d = x - i;
+      const double d2 = d * d;
+      const double d3 = d2 * d;
+      const double m = 1.0 - d;
+      w[0] = m * m * m / 6.0;
+      w[1] = (4.0 - 6.0 * d2 + 3.0 * d3) / 6.0;
+      w[2] = (1.0 + 3.0 * d + 3.0 * d2 - 3.0 * d3) / 6.0;
+      w[3] = d3 / 6.0;
+      return i - 1;
+    }
+  }
+};
+
+/**
+ * @brief Interpolate one component with precomputed stencil weights
+ *
+ * @tparam Dim Dimension of the interpolation
+ * @tparam W Number of nodes of the stencil along each axis
+ * @tparam T Data type
+ * @param f Pointer to the first node of the stencil
+ * @param sx Stride of the X-axis
+ * @param sy Stride of the Y-axis
+ * @param sz Stride of the Z-axis
+ * @param wx Weights along the X-axis
+ * @param wy Weights along the Y-axis, unused in 1D
+ * @param wz Weights along the Z-axis, unused in 1D and 2D
+ * @return double Interpolated value
+ * @details
+ * The sum is nested with the X-axis outside, in the same order as the
+ * linear, bilinear, and trilinear interpolation of Mesh, so that the CIC
+ * result is the same to the last bit.
+ */
+template <int Dim, int W, typename T>
+inline double ShapeInterpolation(const T* f, int sx, int sy, int sz,
+                                 const double* wx, const double* wy,
+                                 const double* wz) {
+  if constexpr (Dim == 1) {
+    (void)sy;
+    (void)sz;
+    (void)wy;
+    (void)wz;
+    double r = wx[0] * f[0];
+    for (int a = 1; a < W; ++a) {
+      r += wx[a] * f[a * sx];
+    }
+    return r;
+  } else {
+    // Interpolate the remaining axes on each X node
+    double r = wx[0] * ShapeInterpolation<Dim - 1, W>(f, sy, sz, 0, wy, wz,
+                                                      nullptr);
+    for (int a = 1; a < W; ++a) {
+      r += wx[a] * ShapeInterpolation<Dim - 1, W>(f + a * sx, sy, sz, 0, wy,
+                                                  wz, nullptr);
+    }
+    return r;
+  }
+}
+}  // namespace lili::mesh
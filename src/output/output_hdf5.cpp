@@ -0,0 +1,53 @@
+/**
+ * @file    output_hdf5.cpp
+ * @brief   Source file for the HDF5 dataset output settings
+ */
+#include "output_hdf5.hpp"
+
+#include <algorithm>
+
+namespace lili::output {
+H5Compression h5_compression;
+std::mutex h5_mutex;
+
+hid_t H5DatasetCreatePlist(int rank, const hsize_t* dims,
+                           const H5Compression& compression) {
+  if (compression.deflate <= 0) {
+    return H5P_DEFAULT;
+  }
+  for (int d = 0; d < rank; ++d) {
+    if (dims[d] == 0) {
+      return H5P_DEFAULT;
+    }
+  }
+  if (H5Zfilter_avail(H5Z_FILTER_DEFLATE) <= 0) {
+    return H5P_DEFAULT;
+  }
+
+  // Fill the chunk from the fastest varying dimension
+  hsize_t chunk[H5S_MAX_RANK];
+  hsize_t remaining = std::max<hsize_t>(compression.chunk, 1);
+  for (int d = rank - 1; d >= 0; --d) {
+    chunk[d] = std::clamp<hsize_t>(remaining, 1, dims[d]);
+    remaining /= chunk[d];
+  }
+
+  hid_t plist_id = H5Pcreate(H5P_DATASET_CREATE);
+  H5Pset_chunk(plist_id, rank, chunk);
+  if (compression.shuffle) {
+    H5Pset_shuffle(plist_id);
+  }
+  H5Pset_deflate(plist_id, compression.deflate);
+  return plist_id;
+}
+
+hid_t H5DatasetCreatePlist(int rank, const hsize_t* dims) {
+  return H5DatasetCreatePlist(rank, dims, h5_compression);
+}
+
+void H5ClosePlist(hid_t plist_id) {
+  if (plist_id != H5P_DEFAULT) {
+    H5Pclose(plist_id);
+  }
+}
+}  // namespace lili::output
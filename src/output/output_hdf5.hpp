@@ -0,0 +1,76 @@
+/**
+ * @file output_hdf5.hpp
+ * @brief Header file for the HDF5 dataset output settings
+ */
+#pragma once
+
+#include <mutex>
+
+#include "hdf5.h"
+
+namespace lili::output {
+/**
+ * @brief Default target number of elements per dataset chunk
+ */
+#ifndef __LILI_H5_CHUNK
+#define __LILI_H5_CHUNK 65536
+#endif
+
+/**
+ * @brief Compression settings of the HDF5 datasets
+ *
+ * @details
+ * When `deflate` is positive, the datasets are stored in chunks of about
+ * `chunk` elements and compressed with the deflate filter, after the
+ * byte-shuffle filter if `shuffle` is set. Shuffling groups the bytes of the
+ * same significance together, which typically makes the particle and field
+ * data 2-4 times smaller. The filters are transparent when reading the data
+ * back.
+ */
+struct H5Compression {
+  int deflate = 0;                  ///< Deflate level in `[1, 9]`, 0 to disable
+  bool shuffle = true;              ///< Whether to byte-shuffle the data
+  hsize_t chunk = __LILI_H5_CHUNK;  ///< Target number of elements per chunk
+};
+
+/**
+ * @brief Compression settings used by all of the HDF5 output
+ */
+extern H5Compression h5_compression;
+
+/**
+ * @brief Mutex serializing the HDF5 output routines
+ *
+ * @details
+ * HDF5 is usually not built thread-safe. Every routine opening an HDF5 file
+ * holds this mutex while the file is open, so that a file can be written by a
+ * background thread while the simulation loop keeps saving other outputs.
+ */
+extern std::mutex h5_mutex;
+
+// Function declaration
+/**
+ * @brief Create the dataset creation property list of an output dataset
+ *
+ * @param rank Number of dimensions of the dataset
+ * @param dims Size of the dataset in each dimension
+ * @param compression Compression settings
+ * @return hid_t Dataset creation property list, `H5P_DEFAULT` if the dataset
+ * is not compressed
+ * @details
+ * The chunk covers the fastest varying dimensions first, up to the target
+ * number of elements. The dataset is not compressed if it is empty or if the
+ * deflate filter is not available. The property list has to be closed with
+ * H5ClosePlist.
+ */
+hid_t H5DatasetCreatePlist(int rank, const hsize_t* dims,
+                           const H5Compression& compression);
+hid_t H5DatasetCreatePlist(int rank, const hsize_t* dims);
+
+/**
+ * @brief Close a property list unless it is `H5P_DEFAULT`
+ *
+ * @param plist_id Property list
+ */
+void H5ClosePlist(hid_t plist_id);
+}  // namespace lili::output
@@ -5,34 +5,158 @@
 
 #include "particle.hpp"
 
+#include <cmath>
+#include <cstring>
 #include <fstream>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include "hdf5.h"
+#include "output_hdf5.hpp"
+#include "particle_hdf5.hpp"
 
 namespace lili::particle {
 const char* __LILIP_DNAME_UINT32[] = {"id", "status"};
-const char* __LILIP_DNAME_DOUBLE[] = {"x", "y", "z", "u", "v", "w"};
+const char* __LILIP_DNAME_REAL[] = {"x", "y", "z", "u", "v", "w"};
+const char* __LILIP_DNAME_CELL[] = {"ix", "iy", "iz"};
+
+int ParticlesCapacity(int npar) {
+  int npar_max = npar + npar / __LILIP_DEFAULT_HROOM;
+  if (npar_max < __LILIP_DEFAULT_BSIZE) {
+    npar_max = __LILIP_DEFAULT_BSIZE;
+  }
+  return memory::AlignUp(npar_max);
+}
+
+template <typename TX, typename TU>
+std::size_t ParticlesT<TX, TU>::ColumnSize(int icol) const {
+  switch (icol) {
+    case 0:
+      return sizeof(ulong);
+    case 1:
+      return sizeof(ParticleStatus);
+    case 2:
+    case 3:
+    case 4:
+      return sizeof(TX);
+    case 5:
+    case 6:
+    case 7:
+      return sizeof(TU);
+    case 8:
+    case 9:
+    case 10:
+      return (layout_ == input::PPosLayout::Cell) ? sizeof(int) : 0;
+    default:
+      return ColumnTypeSize(columns_[icol - __LILIP_DCOUNT_COLUMN].type);
+  }
+}
+
+template <typename TX, typename TU>
+ColumnType ParticlesT<TX, TU>::ColumnTypeOf(int icol) const {
+  constexpr ColumnType tx =
+      (sizeof(TX) == 4) ? ColumnType::Float32 : ColumnType::Float64;
+  constexpr ColumnType tu =
+      (sizeof(TU) == 4) ? ColumnType::Float32 : ColumnType::Float64;
+  static_assert(sizeof(ulong) == ColumnTypeSize(ColumnType::UInt64));
+  static_assert(sizeof(ParticleStatus) == ColumnTypeSize(ColumnType::UInt8));
+
+  switch (icol) {
+    case 0:
+      return ColumnType::UInt64;
+    case 1:
+      return ColumnType::UInt8;
+    case 2:
+    case 3:
+    case 4:
+      return tx;
+    case 5:
+    case 6:
+    case 7:
+      return tu;
+    case 8:
+    case 9:
+    case 10:
+      return ColumnType::Int32;
+    default:
+      return columns_[icol - __LILIP_DCOUNT_COLUMN].type;
+  }
+}
+
+template <typename TX, typename TU>
+const char* ParticlesT<TX, TU>::ColumnName(int icol) const {
+  if (icol < __LILIP_DCOUNT_ULONG) {
+    return __LILIP_DNAME_UINT32[icol];
+  } else if (icol < __LILIP_DCOUNT_ULONG + __LILIP_DCOUNT_REAL) {
+    return __LILIP_DNAME_REAL[icol - __LILIP_DCOUNT_ULONG];
+  } else if (icol < __LILIP_DCOUNT_COLUMN) {
+    return __LILIP_DNAME_CELL[icol - __LILIP_DCOUNT_ULONG -
+                              __LILIP_DCOUNT_REAL];
+  }
+  return columns_[icol - __LILIP_DCOUNT_COLUMN].name.c_str();
+}
+
+template <typename TX, typename TU>
+int ParticlesT<TX, TU>::FindColumn(const std::string& name) const {
+  for (int icol = 0; icol < ncolumn(); ++icol) {
+    if (name == ColumnName(icol)) {
+      return icol;
+    }
+  }
+  return -1;
+}
+
+template <typename TX, typename TU>
+std::size_t ParticlesT<TX, TU>::ColumnOffset(int icol, int npar_max) const {
+  std::size_t offset = 0;
+  for (int i = 0; i < icol; ++i) {
+    offset += ColumnSize(i) * npar_max;
+  }
+  return offset;
+}
+
+template <typename TX, typename TU>
+std::size_t ParticlesT<TX, TU>::ArenaBytes(int npar_max) const {
+  return ColumnOffset(ncolumn(), npar_max);
+}
 
 // Constructor
-Particles::Particles()
+template <typename TX, typename TU>
+ParticlesT<TX, TU>::ParticlesT()
     : npar_(0),
-      npar_max_(__LILIP_DEFAULT_BSIZE),
+      npar_max_(0),
       q_(1.0),
       m_(1.0),
-      id_(new ulong[__LILIP_DEFAULT_BSIZE]()),
-      status_(new ParticleStatus[__LILIP_DEFAULT_BSIZE]()),
-      x_(new double[__LILIP_DEFAULT_BSIZE]()),
-      y_(new double[__LILIP_DEFAULT_BSIZE]()),
-      z_(new double[__LILIP_DEFAULT_BSIZE]()),
-      u_(new double[__LILIP_DEFAULT_BSIZE]()),
-      v_(new double[__LILIP_DEFAULT_BSIZE]()),
-      w_(new double[__LILIP_DEFAULT_BSIZE]()) {}
-
-Particles::Particles(int npar)
+      layout_(input::PPosLayout::Physical),
+      grid_(),
+      columns_(),
+      id_(nullptr),
+      status_(nullptr),
+      x_(nullptr),
+      y_(nullptr),
+      z_(nullptr),
+      u_(nullptr),
+      v_(nullptr),
+      w_(nullptr),
+      ix_(nullptr),
+      iy_(nullptr),
+      iz_(nullptr) {}
+
+template <typename TX, typename TU>
+ParticlesT<TX, TU>::ParticlesT(int npar)
     : npar_(npar),
-      npar_max_(npar < __LILIP_DEFAULT_BSIZE ? __LILIP_DEFAULT_BSIZE : npar),
+      npar_max_(ParticlesCapacity(npar)),
       q_(1.0),
       m_(1.0),
+      layout_(input::PPosLayout::Physical),
+      grid_(),
+      columns_(),
       id_(nullptr),
       status_(nullptr),
       x_(nullptr),
@@ -40,47 +164,47 @@ Particles::Particles(int npar)
       z_(nullptr),
       u_(nullptr),
       v_(nullptr),
-      w_(nullptr) {
-  id_ = new ulong[npar_max_]();
-  status_ = new ParticleStatus[npar_max_]();
-  x_ = new double[npar_max_]();
-  y_ = new double[npar_max_]();
-  z_ = new double[npar_max_]();
-  u_ = new double[npar_max_]();
-  v_ = new double[npar_max_]();
-  w_ = new double[npar_max_]();
-
-  // Initialize status
-  for (int i = 0; i < npar_; ++i) {
-    status_[i] = ParticleStatus::In;
-  }
+      w_(nullptr),
+      ix_(nullptr),
+      iy_(nullptr),
+      iz_(nullptr) {
+  AllocateArena();
+  InitializeData();
 }
 
-Particles::Particles(int npar, int npar_max)
+template <typename TX, typename TU>
+ParticlesT<TX, TU>::ParticlesT(int npar, int npar_max)
     : npar_(npar),
-      npar_max_(npar_max),
+      npar_max_(memory::AlignUp(std::max(npar, npar_max))),
       q_(1.0),
       m_(1.0),
-      id_(new ulong[npar_max]()),
-      status_(new ParticleStatus[npar_max]()),
-      x_(new double[npar_max]()),
-      y_(new double[npar_max]()),
-      z_(new double[npar_max]()),
-      u_(new double[npar_max]()),
-      v_(new double[npar_max]()),
-      w_(new double[npar_max]()) {
-  // Initialize status
-  for (int i = 0; i < npar_; ++i) {
-    status_[i] = ParticleStatus::In;
-  }
+      layout_(input::PPosLayout::Physical),
+      grid_(),
+      columns_(),
+      id_(nullptr),
+      status_(nullptr),
+      x_(nullptr),
+      y_(nullptr),
+      z_(nullptr),
+      u_(nullptr),
+      v_(nullptr),
+      w_(nullptr),
+      ix_(nullptr),
+      iy_(nullptr),
+      iz_(nullptr) {
+  AllocateArena();
+  InitializeData();
 }
 
-Particles::Particles(input::InputParticles input_particle)
+template <typename TX, typename TU>
+ParticlesT<TX, TU>::ParticlesT(const input::InputParticles& input_particle)
     : npar_(input_particle.n),
-      npar_max_(input_particle.n < __LILIP_DEFAULT_BSIZE ? __LILIP_DEFAULT_BSIZE
-                                                         : input_particle.n),
+      npar_max_(ParticlesCapacity(input_particle.n)),
       q_(input_particle.q),
       m_(input_particle.m),
+      layout_(input::PPosLayout::Physical),
+      grid_(),
+      columns_(),
       id_(nullptr),
       status_(nullptr),
       x_(nullptr),
@@ -88,248 +212,659 @@ Particles::Particles(input::InputParticles input_particle)
       z_(nullptr),
       u_(nullptr),
       v_(nullptr),
-      w_(nullptr) {
-  id_ = new ulong[npar_max_]();
-  status_ = new ParticleStatus[npar_max_]();
-  x_ = new double[npar_max_]();
-  y_ = new double[npar_max_]();
-  z_ = new double[npar_max_]();
-  u_ = new double[npar_max_]();
-  v_ = new double[npar_max_]();
-  w_ = new double[npar_max_]();
-
-  // Initialize status
-  for (int i = 0; i < npar_; ++i) {
-    status_[i] = ParticleStatus::In;
-  }
+      w_(nullptr),
+      ix_(nullptr),
+      iy_(nullptr),
+      iz_(nullptr) {
+  AllocateArena();
+  InitializeData();
 }
 
 // Copy constructor
-Particles::Particles(const Particles& other)
+template <typename TX, typename TU>
+ParticlesT<TX, TU>::ParticlesT(const ParticlesT& other)
     : npar_(other.npar_),
       npar_max_(other.npar_max_),
       q_(other.q_),
       m_(other.m_),
-      id_(new ulong[other.npar_max_]()),
-      status_(new ParticleStatus[other.npar_max_]()),
-      x_(new double[other.npar_max_]()),
-      y_(new double[other.npar_max_]()),
-      z_(new double[other.npar_max_]()),
-      u_(new double[other.npar_max_]()),
-      v_(new double[other.npar_max_]()),
-      w_(new double[other.npar_max_]()) {
-  std::copy(other.id_, other.id_ + other.npar_max_, id_);
-  std::copy(other.status_, other.status_ + other.npar_max_, status_);
-  std::copy(other.x_, other.x_ + other.npar_max_, x_);
-  std::copy(other.y_, other.y_ + other.npar_max_, y_);
-  std::copy(other.z_, other.z_ + other.npar_max_, z_);
-  std::copy(other.u_, other.u_ + other.npar_max_, u_);
-  std::copy(other.v_, other.v_ + other.npar_max_, v_);
-  std::copy(other.w_, other.w_ + other.npar_max_, w_);
+      layout_(other.layout_),
+      grid_(other.grid_),
+      columns_(other.columns_),
+      id_(nullptr),
+      status_(nullptr),
+      x_(nullptr),
+      y_(nullptr),
+      z_(nullptr),
+      u_(nullptr),
+      v_(nullptr),
+      w_(nullptr),
+      ix_(nullptr),
+      iy_(nullptr),
+      iz_(nullptr) {
+  AllocateArena();
+
+  // Only the live particles are copied
+  for (int icol = 0; icol < ncolumn() && npar_ > 0; ++icol) {
+    std::memcpy(column(icol), other.column(icol),
+                ColumnSize(icol) * npar_);
+  }
 }
 
 // Destructor
-Particles::~Particles() {
-  delete[] id_;
-  delete[] status_;
-  delete[] x_;
-  delete[] y_;
-  delete[] z_;
-  delete[] u_;
-  delete[] v_;
-  delete[] w_;
-}
-
-void Particles::resize(int new_npar_max) {
-  ulong* new_id = new ulong[new_npar_max]();
-  ParticleStatus* new_status = new ParticleStatus[new_npar_max]();
-  double* new_x = new double[new_npar_max]();
-  double* new_y = new double[new_npar_max]();
-  double* new_z = new double[new_npar_max]();
-  double* new_u = new double[new_npar_max]();
-  double* new_v = new double[new_npar_max]();
-  double* new_w = new double[new_npar_max]();
-
-  std::copy(id_, id_ + npar_max_, new_id);
-  std::copy(status_, status_ + npar_max_, new_status);
-  std::copy(x_, x_ + npar_max_, new_x);
-  std::copy(y_, y_ + npar_max_, new_y);
-  std::copy(z_, z_ + npar_max_, new_z);
-  std::copy(u_, u_ + npar_max_, new_u);
-  std::copy(v_, v_ + npar_max_, new_v);
-  std::copy(w_, w_ + npar_max_, new_w);
-
-  delete[] id_;
-  delete[] status_;
-  delete[] x_;
-  delete[] y_;
-  delete[] z_;
-  delete[] u_;
-  delete[] v_;
-  delete[] w_;
-
-  id_ = new_id;
-  status_ = new_status;
-  x_ = new_x;
-  y_ = new_y;
-  z_ = new_z;
-  u_ = new_u;
-  v_ = new_v;
-  w_ = new_w;
+template <typename TX, typename TU>
+ParticlesT<TX, TU>::~ParticlesT() = default;
 
-  npar_max_ = new_npar_max;
+template <typename TX, typename TU>
+void ParticlesT<TX, TU>::AllocateArena() {
+  arena_.Allocate(ArenaBytes(npar_max_));
+  MapColumns();
 }
 
-void Particles::AddID(int offset) {
-  for (int i = 0; i < npar_; ++i) {
-    id_[i] += offset;
+template <typename TX, typename TU>
+void ParticlesT<TX, TU>::MapColumns() {
+  // No arena, e.g. default constructed or moved from
+  if (arena_.data() == nullptr) {
+    id_ = nullptr;
+    status_ = nullptr;
+    x_ = y_ = z_ = nullptr;
+    u_ = v_ = w_ = nullptr;
+    ix_ = iy_ = iz_ = nullptr;
+    return;
+  }
+
+  char* base = static_cast<char*>(arena_.data());
+  id_ = reinterpret_cast<ulong*>(base + ColumnOffset(0, npar_max_));
+  status_ =
+      reinterpret_cast<ParticleStatus*>(base + ColumnOffset(1, npar_max_));
+  x_ = reinterpret_cast<TX*>(base + ColumnOffset(2, npar_max_));
+  y_ = reinterpret_cast<TX*>(base + ColumnOffset(3, npar_max_));
+  z_ = reinterpret_cast<TX*>(base + ColumnOffset(4, npar_max_));
+  u_ = reinterpret_cast<TU*>(base + ColumnOffset(5, npar_max_));
+  v_ = reinterpret_cast<TU*>(base + ColumnOffset(6, npar_max_));
+  w_ = reinterpret_cast<TU*>(base + ColumnOffset(7, npar_max_));
+
+  // Cell index columns only exist in the cell layout
+  if (layout_ == input::PPosLayout::Cell) {
+    ix_ = reinterpret_cast<int*>(base + ColumnOffset(8, npar_max_));
+    iy_ = reinterpret_cast<int*>(base + ColumnOffset(9, npar_max_));
+    iz_ = reinterpret_cast<int*>(base + ColumnOffset(10, npar_max_));
+  } else {
+    ix_ = nullptr;
+    iy_ = nullptr;
+    iz_ = nullptr;
   }
 }
 
-void Particles::pswap(const int i, const int j) {
-  int tmp_uint32 = id_[i];
-  id_[i] = id_[j];
-  id_[j] = tmp_uint32;
+template <typename TX, typename TU>
+void ParticlesT<TX, TU>::InitializeData() {
+  std::fill(id_, id_ + npar_, 0);
+  std::fill(status_, status_ + npar_, ParticleStatus::In);
+  std::fill(x_, x_ + npar_, TX(0));
+  std::fill(y_, y_ + npar_, TX(0));
+  std::fill(z_, z_ + npar_, TX(0));
+  std::fill(u_, u_ + npar_, TU(0));
+  std::fill(v_, v_ + npar_, TU(0));
+  std::fill(w_, w_ + npar_, TU(0));
+  if (layout_ == input::PPosLayout::Cell) {
+    std::fill(ix_, ix_ + npar_, 0);
+    std::fill(iy_, iy_ + npar_, 0);
+    std::fill(iz_, iz_ + npar_, 0);
+  }
+  for (int icol = __LILIP_DCOUNT_COLUMN; icol < ncolumn(); ++icol) {
+    std::memset(column(icol), 0, ColumnSize(icol) * npar_);
+  }
+}
 
-  ParticleStatus tmp_status = status_[i];
-  status_[i] = status_[j];
-  status_[j] = tmp_status;
+namespace {
+/**
+ * @brief Check whether two meshes describe the same grid
+ */
+bool SameGrid(const mesh::MeshSize& a, const mesh::MeshSize& b) {
+  return a.nx == b.nx && a.ny == b.ny && a.nz == b.nz && a.lx == b.lx &&
+         a.ly == b.ly && a.lz == b.lz && a.x0 == b.x0 && a.y0 == b.y0 &&
+         a.z0 == b.z0;
+}
 
-  double tmp_double = x_[i];
-  x_[i] = x_[j];
-  x_[j] = tmp_double;
+/**
+ * @brief Split a physical coordinate into a cell index and an in-cell offset
+ *
+ * @tparam TX Floating point type of the offset
+ * @param x Physical coordinate
+ * @param x0 Starting point of the mesh
+ * @param crx Number of cells per unit length
+ * @param[out] ix Cell index
+ * @param[out] ox In-cell offset
+ */
+template <typename TX>
+void SplitCell(double x, double x0, double crx, int& ix, TX& ox) {
+  const double rx = (x - x0) * crx;
+  const double fx = std::floor(rx);
+  ix = static_cast<int>(fx);
+  ox = static_cast<TX>(rx - fx);
+}
+}  // namespace
 
-  tmp_double = y_[i];
-  y_[i] = y_[j];
-  y_[j] = tmp_double;
+template <typename TX, typename TU>
+void ParticlesT<TX, TU>::SetLayout(input::PPosLayout layout,
+                                   const mesh::MeshSize& grid) {
+  // Nothing to convert
+  if (layout == layout_ &&
+      (layout == input::PPosLayout::Physical || SameGrid(grid, grid_))) {
+    return;
+  }
 
-  tmp_double = z_[i];
-  z_[i] = z_[j];
-  z_[j] = tmp_double;
+  // Move the current data out and allocate the arena for the new layout
+  ParticlesT old(std::move(*this));
+  npar_ = old.npar_;
+  npar_max_ = old.npar_max_;
+  q_ = old.q_;
+  m_ = old.m_;
+  layout_ = layout;
+  grid_ = grid;
+  columns_ = old.columns_;
+  AllocateArena();
 
-  tmp_double = u_[i];
-  u_[i] = u_[j];
-  u_[j] = tmp_double;
+  // The id, status, velocity, and extra columns are unchanged
+  for (int icol = 0; icol < ncolumn() && npar_ > 0; ++icol) {
+    if ((icol >= 2 && icol <= 4) ||
+        (icol >= 8 && icol < __LILIP_DCOUNT_COLUMN)) {
+      continue;
+    }
+    std::memcpy(column(icol), old.column(icol), ColumnSize(icol) * npar_);
+  }
 
-  tmp_double = v_[i];
-  v_[i] = v_[j];
-  v_[j] = tmp_double;
+  // Convert the positions through the physical coordinate
+  const double crx = grid.nx / grid.lx;
+  const double cry = grid.ny / grid.ly;
+  const double crz = grid.nz / grid.lz;
 
-  tmp_double = w_[i];
-  w_[i] = w_[j];
-  w_[j] = tmp_double;
+#pragma omp parallel for if (npar_ >= __LILIP_DEFAULT_OMPSIZE)
+  for (int i = 0; i < npar_; ++i) {
+    const double xp = old.PhysicalX(i);
+    const double yp = old.PhysicalY(i);
+    const double zp = old.PhysicalZ(i);
+    if (layout == input::PPosLayout::Cell) {
+      SplitCell(xp, grid.x0, crx, ix_[i], x_[i]);
+      SplitCell(yp, grid.y0, cry, iy_[i], y_[i]);
+      SplitCell(zp, grid.z0, crz, iz_[i], z_[i]);
+    } else {
+      x_[i] = xp;
+      y_[i] = yp;
+      z_[i] = zp;
+    }
+  }
 }
 
-void Particles::CleanOut() {
-  // Keep two indices
-  int i = 0;
-  int j = npar_ - 1;
+template <typename TX, typename TU>
+int ParticlesT<TX, TU>::AddColumn(const std::string& name, ColumnType type) {
+  // Column already registered
+  const int icol = FindColumn(name);
+  if (icol >= 0) {
+    if (icol < __LILIP_DCOUNT_COLUMN || ColumnTypeOf(icol) != type) {
+      std::cerr << "Particle column " << name << " already exists..."
+                << std::endl;
+      exit(2);
+    }
+    return icol;
+  }
 
-  // Loop until i and j meet, swap particles if necessary
-  while (i < j) {
-    if (status_[i] == ParticleStatus::Out) {
-      while (status_[j] == ParticleStatus::Out) {
-        --j;
-        if (i >= j) {
-          break;
-        }
-      }
-      if (i >= j) {
-        break;
-      }
-      pswap(i, j);
-      --j;
+  std::vector<ParticleColumn> columns = columns_;
+  columns.push_back({name, type});
+  SetColumns(columns);
+  return ncolumn() - 1;
+}
+
+template <typename TX, typename TU>
+void ParticlesT<TX, TU>::SetColumns(
+    const std::vector<ParticleColumn>& columns) {
+  // Nothing to change
+  if (columns == columns_) {
+    return;
+  }
+
+  // Move the current data out and allocate the arena for the new columns
+  ParticlesT old(std::move(*this));
+  npar_ = old.npar_;
+  npar_max_ = old.npar_max_;
+  q_ = old.q_;
+  m_ = old.m_;
+  layout_ = old.layout_;
+  grid_ = old.grid_;
+  columns_ = columns;
+  AllocateArena();
+
+  // Copy the built-in columns and the extra columns that are kept
+  for (int icol = 0; icol < ncolumn() && npar_ > 0; ++icol) {
+    const int iold = (icol < __LILIP_DCOUNT_COLUMN)
+                         ? icol
+                         : old.FindColumn(ColumnName(icol));
+    if (iold >= 0 && old.ColumnTypeOf(iold) == ColumnTypeOf(icol)) {
+      std::memcpy(column(icol), old.column(iold), ColumnSize(icol) * npar_);
+    } else {
+      std::memset(column(icol), 0, ColumnSize(icol) * npar_);
+    }
+  }
+}
+
+template <typename TX, typename TU>
+void ParticlesT<TX, TU>::resize(int new_npar_max) {
+  new_npar_max = memory::AlignUp(new_npar_max);
+  if (new_npar_max == npar_max_) {
+    return;
+  }
+
+  // Particles beyond the new size are dropped
+  npar_ = std::min(npar_, new_npar_max);
+  const std::size_t new_bytes = ArenaBytes(new_npar_max);
+
+  if (arena_.mapped() && new_npar_max > npar_max_ && arena_.Remap(new_bytes)) {
+    // Grow in place, move the columns from the last one so that the live
+    // entries are never overwritten before they are moved
+    char* base = static_cast<char*>(arena_.data());
+    for (int icol = ncolumn() - 1; icol >= 0; --icol) {
+      std::memmove(base + ColumnOffset(icol, new_npar_max),
+                   base + ColumnOffset(icol, npar_max_),
+                   ColumnSize(icol) * npar_);
     }
-    ++i;
+  } else if (arena_.mapped() && new_npar_max < npar_max_) {
+    // Shrink in place, move the columns from the first one before unmapping
+    char* base = static_cast<char*>(arena_.data());
+    for (int icol = 0; icol < ncolumn(); ++icol) {
+      std::memmove(base + ColumnOffset(icol, new_npar_max),
+                   base + ColumnOffset(icol, npar_max_),
+                   ColumnSize(icol) * npar_);
+    }
+    arena_.Remap(new_bytes);
+  } else {
+    // Move only the live particles into a new arena
+    memory::Arena new_arena(new_bytes);
+    char* old_base = static_cast<char*>(arena_.data());
+    char* new_base = static_cast<char*>(new_arena.data());
+    for (int icol = 0; icol < ncolumn() && npar_ > 0; ++icol) {
+      std::memcpy(new_base + ColumnOffset(icol, new_npar_max),
+                  old_base + ColumnOffset(icol, npar_max_),
+                  ColumnSize(icol) * npar_);
+    }
+    swap(arena_, new_arena);
+  }
+
+  npar_max_ = new_npar_max;
+  MapColumns();
+}
+
+template <typename TX, typename TU>
+void ParticlesT<TX, TU>::Reserve(int npar) {
+  if (npar > npar_max_) {
+    resize(std::max(ParticlesCapacity(npar),
+                    npar_max_ * __LILIP_DEFAULT_GSIZE));
+  }
+}
+
+template <typename TX, typename TU>
+void ParticlesT<TX, TU>::CopyFrom(const ParticlesT& other) {
+  if (this == &other) {
+    return;
+  }
+
+  // Reallocate only if the arena does not fit the other particles
+  if (layout_ != other.layout_ || columns_ != other.columns_ ||
+      npar_max_ < other.npar_) {
+    npar_max_ = std::max(npar_max_, other.npar_max_);
+    layout_ = other.layout_;
+    columns_ = other.columns_;
+    AllocateArena();
+  }
+
+  npar_ = other.npar_;
+  q_ = other.q_;
+  m_ = other.m_;
+  grid_ = other.grid_;
+
+  // Only the live particles are copied
+  for (int icol = 0; icol < ncolumn() && npar_ > 0; ++icol) {
+    std::memcpy(column(icol), other.column(icol),
+                ColumnSize(icol) * npar_);
+  }
+}
+
+template <typename TX, typename TU>
+void ParticlesT<TX, TU>::AddID(int offset) {
+  for (int i = 0; i < npar_; ++i) {
+    id_[i] += offset;
+  }
+}
+
+template <typename TX, typename TU>
+void ParticlesT<TX, TU>::pswap(const int i, const int j) {
+  for (int icol = 0; icol < ncolumn(); ++icol) {
+    const std::size_t size = ColumnSize(icol);
+    char* data = static_cast<char*>(column(icol));
+    std::swap_ranges(data + size * i, data + size * (i + 1), data + size * j);
+  }
+}
+
+template <typename TX, typename TU>
+void ParticlesT<TX, TU>::CleanOut() {
+  // Mask the particles that are out of the domain
+  std::vector<uint8_t> mask(npar_);
+
+#pragma omp parallel for if (npar_ >= __LILIP_DEFAULT_OMPSIZE)
+  for (int i = 0; i < npar_; ++i) {
+    mask[i] = HasStatus(status_[i], ParticleStatus::Out);
   }
 
-  // Check the last particle
-  if (status_[i] == ParticleStatus::Out) {
-    --i;
+  // Remove them while keeping the order of the rest
+  CompactParticles<TX, TU>(*this, mask.data(), nullptr, true);
+}
+
+namespace {
+/**
+ * @brief HDF5 memory type of a column type
+ *
+ * @param type Column type
+ */
+hid_t ColumnH5Type(ColumnType type) {
+  switch (type) {
+    case ColumnType::UInt8:
+      return H5NativeType<uint8_t>();
+    case ColumnType::Int32:
+      return H5NativeType<int32_t>();
+    case ColumnType::UInt64:
+      return H5NativeType<ulong>();
+    case ColumnType::Float32:
+      return H5NativeType<float>();
+    default:
+      return H5NativeType<double>();
   }
+}
 
-  // Change the number of particles
-  npar_ = i + 1;
+/**
+ * @brief Column type of an HDF5 dataset
+ *
+ * @param[in] dataset_id HDF5 dataset
+ * @param[out] type Column type
+ * @return bool Whether the dataset can be stored in a column
+ */
+bool DatasetColumnType(hid_t dataset_id, ColumnType& type) {
+  hid_t type_id = H5Dget_type(dataset_id);
+  const H5T_class_t type_class = H5Tget_class(type_id);
+  const std::size_t size = H5Tget_size(type_id);
+  H5Tclose(type_id);
+
+  if (type_class == H5T_FLOAT) {
+    type = (size == 4) ? ColumnType::Float32 : ColumnType::Float64;
+    return true;
+  } else if (type_class == H5T_INTEGER) {
+    type = (size == 1)   ? ColumnType::UInt8
+           : (size == 4) ? ColumnType::Int32
+                         : ColumnType::UInt64;
+    return size == 1 || size == 4 || size == 8;
+  }
+  return false;
 }
+}  // namespace
 
+namespace {
 /**
- * @brief Function to save particle data
+ * @brief Check whether a column is stored in the HDF5 file
+ *
+ * @param icol Index of the column in the arena
+ * @details
+ * The cell index columns are merged into the physical coordinate.
+ */
+bool StoredColumn(int icol) {
+  return icol < __LILIP_DCOUNT_ULONG + __LILIP_DCOUNT_REAL ||
+         icol >= __LILIP_DCOUNT_COLUMN;
+}
+
+/**
+ * @brief Write the particles as a slice of the particle datasets
+ *
  * @param particles Particles object
  * @param file_name Name of the file to save to
+ * @param fapl_id HDF5 file access property list
+ * @param dxpl_id HDF5 dataset transfer property list
+ * @param offset Offset of the slice in the datasets
+ * @param total Total number of particles in the datasets
  */
-void SaveParticles(Particles& particles, const char* file_name) {
+template <typename TX, typename TU>
+void WriteParticles(ParticlesT<TX, TU>& particles, const char* file_name,
+                    hid_t fapl_id, hid_t dxpl_id, hsize_t offset,
+                    hsize_t total) {
   // Create file
-  hid_t file_id = H5Fcreate(file_name, H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+  hid_t file_id = H5Fcreate(file_name, H5F_ACC_TRUNC, H5P_DEFAULT, fapl_id);
 
-  // Create dataspace to store particles
-  hsize_t dims[1] = {static_cast<hsize_t>(particles.npar())};
+  // Create dataspace to store particles and select the slice
+  hsize_t dims[1] = {total};
+  hsize_t count[1] = {static_cast<hsize_t>(particles.npar())};
+  hsize_t start[1] = {offset};
   hid_t dataspace_id = H5Screate_simple(1, dims, NULL);
+  hid_t memspace_id = H5Screate_simple(1, count, NULL);
+  H5Sselect_hyperslab(dataspace_id, H5S_SELECT_SET, start, NULL, count, NULL);
+  hid_t dcpl_id = lili::output::H5DatasetCreatePlist(1, dims);
 
-  // Create dataset for each integer fields
-  for (int i = 0; i < __LILIP_DCOUNT_ULONG; ++i) {
-    hid_t dataset_id =
-        H5Dcreate(file_id, __LILIP_DNAME_UINT32[i], H5T_NATIVE_UINT32,
-                  dataspace_id, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  // Buffer for the physical coordinate in the cell layout
+  const bool cell = (particles.layout() == input::PPosLayout::Cell);
+  std::vector<double> position(cell ? particles.npar() : 0);
 
-    // Write data
-    H5Dwrite(dataset_id, H5T_NATIVE_UINT32, H5S_ALL, H5S_ALL, H5P_DEFAULT,
-             particles.data_uint32(i));
+  // Create dataset for each column with its in-memory type
+  for (int icol = 0; icol < particles.ncolumn(); ++icol) {
+    if (!StoredColumn(icol)) {
+      continue;
+    }
+    hid_t type_id = ColumnH5Type(particles.ColumnTypeOf(icol));
+    const void* data = particles.column(icol);
 
-    // Close dataset
-    H5Dclose(dataset_id);
-  }
+    // Convert the cell index and offset to the physical coordinate
+    if (cell && icol >= 2 && icol <= 4) {
+      for (int i = 0; i < particles.npar(); ++i) {
+        position[i] = (icol == 2)   ? particles.PhysicalX(i)
+                      : (icol == 3) ? particles.PhysicalY(i)
+                                    : particles.PhysicalZ(i);
+      }
+      type_id = H5T_NATIVE_DOUBLE;
+      data = position.data();
+    }
 
-  // Create dataset for each double fields
-  for (int i = 0; i < __LILIP_DCOUNT_DOUBLE; ++i) {
-    hid_t dataset_id =
-        H5Dcreate(file_id, __LILIP_DNAME_DOUBLE[i], H5T_NATIVE_DOUBLE,
-                  dataspace_id, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    hid_t dataset_id = H5Dcreate(file_id, particles.ColumnName(icol), type_id,
+                                 dataspace_id, H5P_DEFAULT, dcpl_id,
+                                 H5P_DEFAULT);
 
     // Write data
-    H5Dwrite(dataset_id, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT,
-             particles.data_double(i));
+    H5Dwrite(dataset_id, type_id, memspace_id, dataspace_id, dxpl_id, data);
 
     // Close dataset
     H5Dclose(dataset_id);
   }
 
-  // Close dataspace
+  // Close dataspaces and property list
+  H5Sclose(memspace_id);
   H5Sclose(dataspace_id);
+  lili::output::H5ClosePlist(dcpl_id);
+
+  // Tag the status values with their format
+  const int format = __LILIP_STATUS_FORMAT;
+  hid_t attrspace_id = H5Screate(H5S_SCALAR);
+  hid_t attr_id = H5Acreate(file_id, "status_format", H5T_NATIVE_INT,
+                            attrspace_id, H5P_DEFAULT, H5P_DEFAULT);
+  H5Awrite(attr_id, H5T_NATIVE_INT, &format);
+  H5Aclose(attr_id);
+  H5Sclose(attrspace_id);
 
   // Close file
   H5Fclose(file_id);
 }
 
-Particles LoadParticles(const char* file_name) {
-  // Open file
-  hid_t file_id = H5Fopen(file_name, H5F_ACC_RDONLY, H5P_DEFAULT);
+/**
+ * @brief Format of the status values of an open file
+ *
+ * @param file_id HDF5 file
+ * @return int Value of the `status_format` attribute, 0 for the files
+ * written with the legacy status enumeration
+ */
+int StatusFormat(hid_t file_id) {
+  int format = 0;
+  if (H5Aexists(file_id, "status_format") > 0) {
+    hid_t attr_id = H5Aopen(file_id, "status_format", H5P_DEFAULT);
+    H5Aread(attr_id, H5T_NATIVE_INT, &format);
+    H5Aclose(attr_id);
+  }
+  return format;
+}
 
-  // Get number of particles
+/**
+ * @brief Number of particles in the datasets of an open file
+ *
+ * @param file_id HDF5 file
+ */
+hsize_t DatasetParticles(hid_t file_id) {
   hsize_t dims[1];
   hid_t dataset_id = H5Dopen(file_id, __LILIP_DNAME_UINT32[0], H5P_DEFAULT);
   hid_t dataspace_id = H5Dget_space(dataset_id);
   H5Sget_simple_extent_dims(dataspace_id, dims, NULL);
-  int npar = dims[0];
+  H5Sclose(dataspace_id);
+  H5Dclose(dataset_id);
+  return dims[0];
+}
 
-  // Create particles object
-  Particles particles(npar);
+/**
+ * @brief Register the datasets of an open file that are not built-in columns
+ * as extra columns
+ *
+ * @param file_id HDF5 file
+ * @param particles Particles object
+ */
+template <typename TX, typename TU>
+void AddDatasetColumns(hid_t file_id, ParticlesT<TX, TU>& particles) {
+  std::vector<ParticleColumn> columns = particles.columns();
+  H5G_info_t group_info;
+  H5Gget_info(file_id, &group_info);
+  for (hsize_t k = 0; k < group_info.nlinks; ++k) {
+    char name[256];
+    H5Lget_name_by_idx(file_id, ".", H5_INDEX_NAME, H5_ITER_INC, k, name,
+                       sizeof(name), H5P_DEFAULT);
+    if (particles.FindColumn(name) >= 0) {
+      continue;
+    }
 
-  // Read data
-  for (int i = 0; i < __LILIP_DCOUNT_ULONG; ++i) {
-    dataset_id = H5Dopen(file_id, __LILIP_DNAME_UINT32[i], H5P_DEFAULT);
-    H5Dread(dataset_id, H5T_NATIVE_ULONG, H5S_ALL, H5S_ALL, H5P_DEFAULT,
-            particles.data_uint32(i));
+    ColumnType type;
+    hid_t dataset_id = H5Dopen(file_id, name, H5P_DEFAULT);
+    if (DatasetColumnType(dataset_id, type)) {
+      columns.push_back({name, type});
+    }
     H5Dclose(dataset_id);
   }
-  for (int i = 0; i < __LILIP_DCOUNT_DOUBLE; ++i) {
-    dataset_id = H5Dopen(file_id, __LILIP_DNAME_DOUBLE[i], H5P_DEFAULT);
-    H5Dread(dataset_id, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT,
-            particles.data_double(i));
+  particles.SetColumns(columns);
+}
+
+/**
+ * @brief Read a range of the particle datasets into a Particles object
+ *
+ * @param file_id HDF5 file
+ * @param dxpl_id HDF5 dataset transfer property list
+ * @param particles Particles object with room for `count` particles
+ * @param start First particle of the range in the datasets
+ * @param count Number of particles in the range
+ * @details
+ * HDF5 converts each dataset to the in-memory type of its column. The
+ * `status` of files without the `status_format` attribute holds the legacy
+ * enumeration, its values are translated to the flags with LegacyStatus
+ * after the read. Only the selected range is read from the file.
+ */
+template <typename TX, typename TU>
+void ReadParticleRange(hid_t file_id, hid_t dxpl_id,
+                       ParticlesT<TX, TU>& particles, hsize_t start,
+                       hsize_t count) {
+  particles.npar() = count;
+
+  hsize_t offset[1] = {start};
+  hsize_t size[1] = {count};
+  // Status values of the file
+  const int format = StatusFormat(file_id);
+  if (format > __LILIP_STATUS_FORMAT) {
+    std::cerr << "Unsupported particle status format " << format << "..."
+              << std::endl;
+    exit(2);
+  }
+
+  hid_t memspace_id = H5Screate_simple(1, size, NULL);
+  for (int icol = 0; icol < particles.ncolumn(); ++icol) {
+    if (!StoredColumn(icol)) {
+      continue;
+    }
+    hid_t dataset_id =
+        H5Dopen(file_id, particles.ColumnName(icol), H5P_DEFAULT);
+    hid_t dataspace_id = H5Dget_space(dataset_id);
+    if (count > 0) {
+      H5Sselect_hyperslab(dataspace_id, H5S_SELECT_SET, offset, NULL, size,
+                          NULL);
+    } else {
+      H5Sselect_none(dataspace_id);
+      H5Sselect_none(memspace_id);
+    }
+    H5Dread(dataset_id, ColumnH5Type(particles.ColumnTypeOf(icol)),
+            memspace_id, dataspace_id, dxpl_id, particles.column(icol));
+    H5Sclose(dataspace_id);
     H5Dclose(dataset_id);
   }
+  H5Sclose(memspace_id);
 
-  // Close dataspace
-  H5Sclose(dataspace_id);
+  // Convert the legacy status enumeration to the flags
+  if (format == 0) {
+    ParticleStatus* status = particles.status();
+    for (hsize_t i = 0; i < count; ++i) {
+      if (!LegacyStatus(static_cast<uint8_t>(status[i]), status[i])) {
+        std::cerr << "Invalid legacy particle status "
+                  << static_cast<int>(status[i]) << "..." << std::endl;
+        exit(2);
+      }
+    }
+  }
+}
+
+/**
+ * @brief Read a range of the particle datasets
+ *
+ * @param file_name Name of the file to load from
+ * @param fapl_id HDF5 file access property list
+ * @param dxpl_id HDF5 dataset transfer property list
+ * @param islice Index of the slice to read, or first particle of the range if
+ * `nslice` is zero
+ * @param nslice Number of slices the datasets are split into, or zero to read
+ * the `count` particles from `islice`
+ * @param count Number of particles of the range, negative to read until the
+ * end of the datasets
+ * @return ParticlesT<TX, TU> Particles object sized for the range
+ * @details
+ * The datasets are split into `nslice` contiguous slices of nearly equal
+ * size, independently of how they were written. The Particles object has no
+ * headroom, it grows on demand if particles are added.
+ */
+template <typename TX, typename TU>
+ParticlesT<TX, TU> ReadParticles(const char* file_name, hid_t fapl_id,
+                                 hid_t dxpl_id, long islice, long nslice,
+                                 long count = -1) {
+  // Open file
+  hid_t file_id = H5Fopen(file_name, H5F_ACC_RDONLY, fapl_id);
+
+  // Range of particles to read
+  const hsize_t npar = DatasetParticles(file_id);
+  hsize_t start, size;
+  if (nslice > 0) {
+    start = npar * islice / nslice;
+    size = npar * (islice + 1) / nslice - start;
+  } else {
+    start = std::min<hsize_t>(std::max(islice, 0L), npar);
+    size = (count < 0) ? npar - start
+                       : std::min<hsize_t>(count, npar - start);
+  }
+
+  // Create particles object with the exact size and the stored columns
+  ParticlesT<TX, TU> particles(0, size);
+  AddDatasetColumns(file_id, particles);
+
+  // Read data
+  ReadParticleRange(file_id, dxpl_id, particles, start, size);
 
   // Close file
   H5Fclose(file_id);
@@ -337,221 +872,619 @@ Particles LoadParticles(const char* file_name) {
   return particles;
 }
 
-void SelectParticles(Particles& input, Particles& output, ParticleStatus status,
-                     bool remove) {
-  int npar = input.npar();
+/**
+ * @brief Create the HDF5 property lists for collective MPI-IO
+ *
+ * @param[in] comm MPI communicator
+ * @param[out] fapl_id HDF5 file access property list
+ * @param[out] dxpl_id HDF5 dataset transfer property list
+ * @details
+ * The simulation exits if HDF5 is not built with parallel support and more
+ * than one rank is used, otherwise the default property lists are used.
+ */
+void CollectivePropertyLists(MPI_Comm comm, hid_t& fapl_id, hid_t& dxpl_id) {
+#ifdef H5_HAVE_PARALLEL
+  fapl_id = H5Pcreate(H5P_FILE_ACCESS);
+  H5Pset_fapl_mpio(fapl_id, comm, MPI_INFO_NULL);
+  dxpl_id = H5Pcreate(H5P_DATASET_XFER);
+  H5Pset_dxpl_mpio(dxpl_id, H5FD_MPIO_COLLECTIVE);
+#else
+  int comm_size;
+  MPI_Comm_size(comm, &comm_size);
+  if (comm_size > 1) {
+    std::cerr << "Collective particle I/O needs HDF5 with parallel support..."
+              << std::endl;
+    exit(2);
+  }
+  fapl_id = H5P_DEFAULT;
+  dxpl_id = H5P_DEFAULT;
+#endif
+}
 
-  // Loop over input particles
-  int npar_out = 0;
-  for (int i = 0; i < npar; ++i) {
-    if (input.status(i) == status) {
-      // Grow the output particles if necessary
-      if (npar_out >= output.npar_max()) {
-        output.resize(output.npar_max() * __LILIP_DEFAULT_GSIZE);
+/**
+ * @brief Close the HDF5 property lists created by CollectivePropertyLists
+ */
+void ClosePropertyLists(hid_t fapl_id, hid_t dxpl_id) {
+  if (fapl_id != H5P_DEFAULT) {
+    H5Pclose(fapl_id);
+  }
+  if (dxpl_id != H5P_DEFAULT) {
+    H5Pclose(dxpl_id);
+  }
+}
+}  // namespace
+
+template <typename TX, typename TU>
+void SaveParticles(ParticlesT<TX, TU>& particles, const char* file_name) {
+  std::lock_guard<std::mutex> lock(lili::output::h5_mutex);
+  WriteParticles(particles, file_name, H5P_DEFAULT, H5P_DEFAULT, 0,
+                 particles.npar());
+}
+
+template <typename TX, typename TU>
+void SaveParticles(ParticlesT<TX, TU>& particles, const char* file_name,
+                   MPI_Comm comm) {
+  // Offset of each rank in the datasets
+  long npar = particles.npar();
+  long offset = 0;
+  long total = 0;
+  int comm_rank;
+  MPI_Comm_rank(comm, &comm_rank);
+  MPI_Exscan(&npar, &offset, 1, MPI_LONG, MPI_SUM, comm);
+  MPI_Allreduce(&npar, &total, 1, MPI_LONG, MPI_SUM, comm);
+  if (comm_rank == 0) {
+    offset = 0;
+  }
+
+  // Serialize the HDF5 calls with the other output routines
+  std::lock_guard<std::mutex> lock(lili::output::h5_mutex);
+  hid_t fapl_id, dxpl_id;
+  CollectivePropertyLists(comm, fapl_id, dxpl_id);
+  WriteParticles(particles, file_name, fapl_id, dxpl_id, offset, total);
+  ClosePropertyLists(fapl_id, dxpl_id);
+}
+
+template <typename TX, typename TU>
+ParticlesT<TX, TU> LoadParticles(const char* file_name) {
+  std::lock_guard<std::mutex> lock(lili::output::h5_mutex);
+  return ReadParticles<TX, TU>(file_name, H5P_DEFAULT, H5P_DEFAULT, 0, 1);
+}
+
+template <typename TX, typename TU>
+ParticlesT<TX, TU> LoadParticles(const char* file_name, long start,
+                                 long count) {
+  std::lock_guard<std::mutex> lock(lili::output::h5_mutex);
+  return ReadParticles<TX, TU>(file_name, H5P_DEFAULT, H5P_DEFAULT, start, 0,
+                               count);
+}
+
+template <typename TX, typename TU>
+void StreamParticles(
+    const char* file_name, long start, long count, int chunk,
+    const std::function<void(ParticlesT<TX, TU>&, long)>& process) {
+  // Open file and register the stored columns in the chunk buffer
+  std::unique_lock<std::mutex> lock(lili::output::h5_mutex);
+  hid_t file_id = H5Fopen(file_name, H5F_ACC_RDONLY, H5P_DEFAULT);
+  const long npar = DatasetParticles(file_id);
+  start = std::clamp(start, 0L, npar);
+  const long end = (count < 0) ? npar : std::min(start + count, npar);
+  chunk = std::max(chunk, 1);
+
+  ParticlesT<TX, TU> buffer(0, chunk);
+  AddDatasetColumns(file_id, buffer);
+  lock.unlock();
+
+  // Read and process one chunk at a time, the HDF5 calls are serialized with
+  // the other output routines but not the processing
+  for (long offset = start; offset < end; offset += chunk) {
+    lock.lock();
+    ReadParticleRange(file_id, H5P_DEFAULT, buffer, offset,
+                      std::min<long>(chunk, end - offset));
+    lock.unlock();
+    process(buffer, offset);
+  }
+
+  // Close file
+  lock.lock();
+  H5Fclose(file_id);
+}
+
+long CountParticles(const char* file_name) {
+  std::lock_guard<std::mutex> lock(lili::output::h5_mutex);
+  hid_t file_id = H5Fopen(file_name, H5F_ACC_RDONLY, H5P_DEFAULT);
+  const long npar = DatasetParticles(file_id);
+  H5Fclose(file_id);
+  return npar;
+}
+
+template <typename TX, typename TU>
+ParticlesT<TX, TU> LoadParticles(const char* file_name, MPI_Comm comm) {
+  int comm_rank, comm_size;
+  MPI_Comm_rank(comm, &comm_rank);
+  MPI_Comm_size(comm, &comm_size);
+
+  // Serialize the HDF5 calls with the other output routines
+  std::lock_guard<std::mutex> lock(lili::output::h5_mutex);
+  hid_t fapl_id, dxpl_id;
+  CollectivePropertyLists(comm, fapl_id, dxpl_id);
+  ParticlesT<TX, TU> particles =
+      ReadParticles<TX, TU>(file_name, fapl_id, dxpl_id, comm_rank, comm_size);
+  ClosePropertyLists(fapl_id, dxpl_id);
+
+  return particles;
+}
+
+namespace {
+/**
+ * @brief Scatter one column of a stable compaction
+ *
+ * @tparam T Element type of the column
+ * @param in Input column
+ * @param keep Destination for the unmasked elements, `nullptr` to skip
+ * @param sel Destination for the masked elements, `nullptr` to skip
+ * @param mask Particle mask
+ * @param lo First index of the chunk
+ * @param hi Last index (exclusive) of the chunk
+ * @param ikeep Offset of the chunk in `keep`
+ * @param isel Offset of the chunk in `sel`
+ */
+template <typename T>
+void ScatterColumn(const T* __restrict__ in, T* __restrict__ keep,
+                   T* __restrict__ sel, const uint8_t* __restrict__ mask,
+                   int lo, int hi, int ikeep, int isel) {
+  for (int i = lo; i < hi; ++i) {
+    if (mask[i]) {
+      if (sel != nullptr) sel[isel++] = in[i];
+    } else {
+      if (keep != nullptr) keep[ikeep++] = in[i];
+    }
+  }
+}
+
+/**
+ * @brief Scatter one column of a stable compaction by its element size
+ */
+void ScatterColumn(std::size_t size, const void* in, void* keep, void* sel,
+                   const uint8_t* mask, int lo, int hi, int ikeep, int isel) {
+  switch (size) {
+    case 1:
+      ScatterColumn(static_cast<const uint8_t*>(in),
+                    static_cast<uint8_t*>(keep), static_cast<uint8_t*>(sel),
+                    mask, lo, hi, ikeep, isel);
+      break;
+    case 4:
+      ScatterColumn(static_cast<const uint32_t*>(in),
+                    static_cast<uint32_t*>(keep), static_cast<uint32_t*>(sel),
+                    mask, lo, hi, ikeep, isel);
+      break;
+    case 8:
+      ScatterColumn(static_cast<const uint64_t*>(in),
+                    static_cast<uint64_t*>(keep), static_cast<uint64_t*>(sel),
+                    mask, lo, hi, ikeep, isel);
+      break;
+    default:
+      std::cerr << "Invalid column size " << size << "..." << std::endl;
+      exit(2);
+  }
+}
+
+/**
+ * @brief Gather one column through a permutation
+ *
+ * @tparam T Element type of the column
+ * @param in Input column
+ * @param out Output column
+ * @param perm Permutation, `out[i] = in[perm[i]]`
+ * @param lo First index of the chunk
+ * @param hi Last index (exclusive) of the chunk
+ */
+template <typename T>
+void GatherColumn(const T* __restrict__ in, T* __restrict__ out,
+                  const int* __restrict__ perm, int lo, int hi) {
+  for (int i = lo; i < hi; ++i) {
+    out[i] = in[perm[i]];
+  }
+}
+
+/**
+ * @brief Gather one column through a permutation by its element size
+ */
+void GatherColumn(std::size_t size, const void* in, void* out, const int* perm,
+                  int lo, int hi) {
+  switch (size) {
+    case 1:
+      GatherColumn(static_cast<const uint8_t*>(in), static_cast<uint8_t*>(out),
+                   perm, lo, hi);
+      break;
+    case 4:
+      GatherColumn(static_cast<const uint32_t*>(in),
+                   static_cast<uint32_t*>(out), perm, lo, hi);
+      break;
+    case 8:
+      GatherColumn(static_cast<const uint64_t*>(in),
+                   static_cast<uint64_t*>(out), perm, lo, hi);
+      break;
+    default:
+      std::cerr << "Invalid column size " << size << "..." << std::endl;
+      exit(2);
+  }
+}
+}  // namespace
+
+template <typename TX, typename TU>
+int CompactParticles(ParticlesT<TX, TU>& particles, const uint8_t* mask,
+                     ParticlesT<TX, TU>* output, bool remove) {
+  const int npar = particles.npar();
+
+  // Nothing to do
+  if (output == nullptr && !remove) {
+    return 0;
+  }
+
+  // The selected particles share the position layout and the columns of
+  // the input
+  if (output != nullptr) {
+    output->SetLayout(particles.layout(), particles.grid());
+    output->SetColumns(particles.columns());
+  }
+
+  // Count and scan buffers, entry t + 1 holds the offset of thread t + 1
+  int nthread = 1;
+#ifdef _OPENMP
+  if (npar >= __LILIP_DEFAULT_OMPSIZE) {
+    nthread = omp_get_max_threads();
+  }
+#endif
+  std::vector<int> ikeep(nthread + 1, 0);
+  std::vector<int> isel(nthread + 1, 0);
+
+  // Size of the team, which can be smaller than requested
+  int nteam_out = 1;
+
+  // Scratch column for the in-place removal
+  memory::Arena scratch;
+  if (remove) {
+    scratch.Allocate(sizeof(uint64_t) * npar);
+  }
+
+#pragma omp parallel num_threads(nthread)
+  {
+    int ithread = 0;
+    int nteam = 1;
+#ifdef _OPENMP
+    ithread = omp_get_thread_num();
+    nteam = omp_get_num_threads();
+#endif
+    const int lo = static_cast<long>(npar) * ithread / nteam;
+    const int hi = static_cast<long>(npar) * (ithread + 1) / nteam;
+
+    // Count
+    int nsel = 0;
+    for (int i = lo; i < hi; ++i) {
+      nsel += (mask[i] != 0);
+    }
+    isel[ithread + 1] = nsel;
+    ikeep[ithread + 1] = (hi - lo) - nsel;
+
+#pragma omp barrier
+    // Scan
+#pragma omp single
+    {
+      for (int t = 0; t < nteam; ++t) {
+        ikeep[t + 1] += ikeep[t];
+        isel[t + 1] += isel[t];
+      }
+      if (output != nullptr) {
+        output->Reserve(isel[nteam]);
       }
+      nteam_out = nteam;
+    }
+
+    // Scatter each column
+    for (int icol = 0; icol < particles.ncolumn(); ++icol) {
+      const std::size_t size = particles.ColumnSize(icol);
+      if (size == 0) {
+        continue;
+      }
+      void* in = particles.column(icol);
+      void* sel = (output != nullptr) ? output->column(icol) : nullptr;
+      void* keep = remove ? scratch.data() : nullptr;
 
-      output.id(npar_out) = input.id(i);
-      output.status(npar_out) = input.status(i);
-      output.x(npar_out) = input.x(i);
-      output.y(npar_out) = input.y(i);
-      output.z(npar_out) = input.z(i);
-      output.u(npar_out) = input.u(i);
-      output.v(npar_out) = input.v(i);
-      output.w(npar_out) = input.w(i);
-      ++npar_out;
+      ScatterColumn(size, in, keep, sel, mask, lo, hi, ikeep[ithread],
+                    isel[ithread]);
+
+      // Copy the kept particles back
       if (remove) {
-        input.status(i) = ParticleStatus::Out;
+#pragma omp barrier
+        std::memcpy(static_cast<char*>(in) + size * ikeep[ithread],
+                    static_cast<char*>(keep) + size * ikeep[ithread],
+                    size * (ikeep[ithread + 1] - ikeep[ithread]));
+#pragma omp barrier
       }
     }
   }
 
-  // Change the number of particles in output
-  output.npar() = npar_out;
-
-  // Clean up input particles
+  // Update the number of particles
+  const int nsel = isel[nteam_out];
+  if (output != nullptr) {
+    output->npar() = nsel;
+  }
   if (remove) {
-    input.CleanOut();
+    particles.npar() = npar - nsel;
   }
+
+  return nsel;
 }
 
-void LabelBoundaryParticles(Particles& particles, mesh::MeshSize mesh_size) {
-  // Get the range of each dimension
-  const double xmin = mesh_size.x0;
-  const double xmax = mesh_size.x0 + mesh_size.lx;
-  const double ymin = mesh_size.y0;
-  const double ymax = mesh_size.y0 + mesh_size.ly;
-  const double zmin = mesh_size.z0;
-  const double zmax = mesh_size.z0 + mesh_size.lz;
-
-  double* __restrict__ x = particles.x();
-  double* __restrict__ y = particles.y();
-  double* __restrict__ z = particles.z();
-  ParticleStatus* __restrict__ status = particles.status();
-
-  // Loop over particles and label them
-  // TODO: Can probably improve this branching logic
-  for (int i = 0; i < particles.npar(); ++i) {
-    if (status[i] == ParticleStatus::Tracked) {
-      if (x[i] < xmin) {
-        if (y[i] < ymin) {
-          if (z[i] < zmin) {
-            status[i] = ParticleStatus::TX0Y0Z0;
-          } else if (z[i] > zmax) {
-            status[i] = ParticleStatus::TX0Y0Z1;
-          } else {
-            status[i] = ParticleStatus::TX0Y0;
-          }
-        } else if (y[i] > ymax) {
-          if (z[i] < zmin) {
-            status[i] = ParticleStatus::TX0Y1Z0;
-          } else if (z[i] > zmax) {
-            status[i] = ParticleStatus::TX0Y1Z1;
-          } else {
-            status[i] = ParticleStatus::TX0Y1;
-          }
-        } else {
-          if (z[i] < zmin) {
-            status[i] = ParticleStatus::TX0Z0;
-          } else if (z[i] > zmax) {
-            status[i] = ParticleStatus::TX0Z1;
-          } else {
-            status[i] = ParticleStatus::TX0;
-          }
-        }
-      } else if (x[i] > xmax) {
-        if (y[i] < ymin) {
-          if (z[i] < zmin) {
-            status[i] = ParticleStatus::TX1Y0Z0;
-          } else if (z[i] > zmax) {
-            status[i] = ParticleStatus::TX1Y0Z1;
-          } else {
-            status[i] = ParticleStatus::TX1Y0;
-          }
-        } else if (y[i] > ymax) {
-          if (z[i] < zmin) {
-            status[i] = ParticleStatus::TX1Y1Z0;
-          } else if (z[i] > zmax) {
-            status[i] = ParticleStatus::TX1Y1Z1;
-          } else {
-            status[i] = ParticleStatus::TX1Y1;
-          }
-        } else {
-          if (z[i] < zmin) {
-            status[i] = ParticleStatus::TX1Z0;
-          } else if (z[i] > zmax) {
-            status[i] = ParticleStatus::TX1Z1;
-          } else {
-            status[i] = ParticleStatus::TX1;
-          }
-        }
-      } else {
-        if (y[i] < ymin) {
-          if (z[i] < zmin) {
-            status[i] = ParticleStatus::TY0Z0;
-          } else if (z[i] > zmax) {
-            status[i] = ParticleStatus::TY0Z1;
-          } else {
-            status[i] = ParticleStatus::TY0;
-          }
-        } else if (y[i] > ymax) {
-          if (z[i] < zmin) {
-            status[i] = ParticleStatus::TY1Z0;
-          } else if (z[i] > zmax) {
-            status[i] = ParticleStatus::TY1Z1;
-          } else {
-            status[i] = ParticleStatus::TY1;
-          }
-        } else {
-          if (z[i] < zmin) {
-            status[i] = ParticleStatus::TZ0;
-          } else if (z[i] > zmax) {
-            status[i] = ParticleStatus::TZ1;
-          }
-        }
+template <typename TX, typename TU>
+void PermuteParticles(ParticlesT<TX, TU>& particles, const int* perm) {
+  const int npar = particles.npar();
+
+  // Scratch column for the permuted data
+  memory::Arena scratch(sizeof(uint64_t) * npar);
+
+  for (int icol = 0; icol < particles.ncolumn(); ++icol) {
+    const std::size_t size = particles.ColumnSize(icol);
+    if (size == 0) {
+      continue;
+    }
+    void* data = particles.column(icol);
+
+#pragma omp parallel if (npar >= __LILIP_DEFAULT_OMPSIZE)
+    {
+      int ithread = 0;
+      int nteam = 1;
+#ifdef _OPENMP
+      ithread = omp_get_thread_num();
+      nteam = omp_get_num_threads();
+#endif
+      const int lo = static_cast<long>(npar) * ithread / nteam;
+      const int hi = static_cast<long>(npar) * (ithread + 1) / nteam;
+
+      GatherColumn(size, data, scratch.data(), perm, lo, hi);
+#pragma omp barrier
+      std::memcpy(static_cast<char*>(data) + size * lo,
+                  static_cast<char*>(scratch.data()) + size * lo,
+                  size * (hi - lo));
+    }
+  }
+}
+
+template <typename TX, typename TU>
+void SortParticlesByKey(ParticlesT<TX, TU>& particles, const uint64_t* key) {
+  const int npar = particles.npar();
+  if (npar < 2) {
+    return;
+  }
+
+  // Get the number of bits needed for the largest key
+  uint64_t key_max = 0;
+#pragma omp parallel for reduction(max : key_max) \
+    if (npar >= __LILIP_DEFAULT_OMPSIZE)
+  for (int i = 0; i < npar; ++i) {
+    key_max = std::max(key_max, key[i]);
+  }
+  int nbit = 0;
+  while (nbit < 64 && (key_max >> nbit) > 0) {
+    ++nbit;
+  }
+
+  // Split the key into equal digits of at most __LILIP_SORT_DBITS bits
+  const int npass = (nbit + __LILIP_SORT_DBITS - 1) / __LILIP_SORT_DBITS;
+  if (npass == 0) {
+    return;
+  }
+  const int dbit = (nbit + npass - 1) / npass;
+  const uint64_t dmask = (uint64_t(1) << dbit) - 1;
+
+  // Least significant digit radix sort of the (key, index) pairs
+  std::vector<uint64_t> key_cur(key, key + npar), key_tmp(npar);
+  std::vector<int> perm(npar), perm_tmp(npar);
+
+  // Digit histogram of each thread, turned into its scatter offsets
+  int nthread = 1;
+#ifdef _OPENMP
+  if (npar >= __LILIP_DEFAULT_OMPSIZE) {
+    nthread = omp_get_max_threads();
+  }
+#endif
+  const int nbucket = 1 << dbit;
+  std::vector<int> count(static_cast<std::size_t>(nthread) * nbucket);
+  std::vector<int> total(nbucket + 1);
+
+#pragma omp parallel num_threads(nthread)
+  {
+    int ithread = 0;
+    int nteam = 1;
+#ifdef _OPENMP
+    ithread = omp_get_thread_num();
+    nteam = omp_get_num_threads();
+#endif
+    const int lo = static_cast<long>(npar) * ithread / nteam;
+    const int hi = static_cast<long>(npar) * (ithread + 1) / nteam;
+    int* hist = count.data() + static_cast<std::size_t>(ithread) * nbucket;
+
+    for (int i = lo; i < hi; ++i) {
+      perm[i] = i;
+    }
+
+    for (int ipass = 0; ipass < npass; ++ipass) {
+      const int shift = ipass * dbit;
+
+      // Count the digits of the slice of the thread
+      std::fill(hist, hist + nbucket, 0);
+      for (int i = lo; i < hi; ++i) {
+        ++hist[(key_cur[i] >> shift) & dmask];
       }
-    } else {
-      if (x[i] < xmin) {
-        if (y[i] < ymin) {
-          if (z[i] < zmin) {
-            status[i] = ParticleStatus::X0Y0Z0;
-          } else if (z[i] > zmax) {
-            status[i] = ParticleStatus::X0Y0Z1;
-          } else {
-            status[i] = ParticleStatus::X0Y0;
-          }
-        } else if (y[i] > ymax) {
-          if (z[i] < zmin) {
-            status[i] = ParticleStatus::X0Y1Z0;
-          } else if (z[i] > zmax) {
-            status[i] = ParticleStatus::X0Y1Z1;
-          } else {
-            status[i] = ParticleStatus::X0Y1;
-          }
-        } else {
-          if (z[i] < zmin) {
-            status[i] = ParticleStatus::X0Z0;
-          } else if (z[i] > zmax) {
-            status[i] = ParticleStatus::X0Z1;
-          } else {
-            status[i] = ParticleStatus::X0;
-          }
-        }
-      } else if (x[i] > xmax) {
-        if (y[i] < ymin) {
-          if (z[i] < zmin) {
-            status[i] = ParticleStatus::X1Y0Z0;
-          } else if (z[i] > zmax) {
-            status[i] = ParticleStatus::X1Y0Z1;
-          } else {
-            status[i] = ParticleStatus::X1Y0;
-          }
-        } else if (y[i] > ymax) {
-          if (z[i] < zmin) {
-            status[i] = ParticleStatus::X1Y1Z0;
-          } else if (z[i] > zmax) {
-            status[i] = ParticleStatus::X1Y1Z1;
-          } else {
-            status[i] = ParticleStatus::X1Y1;
-          }
-        } else {
-          if (z[i] < zmin) {
-            status[i] = ParticleStatus::X1Z0;
-          } else if (z[i] > zmax) {
-            status[i] = ParticleStatus::X1Z1;
-          } else {
-            status[i] = ParticleStatus::X1;
-          }
+#pragma omp barrier
+
+      // Exclusive scan, digit major and thread minor, so that the scatter
+      // keeps the order of equal digits
+#pragma omp for
+      for (int d = 0; d < nbucket; ++d) {
+        int sum = 0;
+        for (int t = 0; t < nteam; ++t) {
+          const int c = count[static_cast<std::size_t>(t) * nbucket + d];
+          count[static_cast<std::size_t>(t) * nbucket + d] = sum;
+          sum += c;
         }
-      } else {
-        if (y[i] < ymin) {
-          if (z[i] < zmin) {
-            status[i] = ParticleStatus::Y0Z0;
-          } else if (z[i] > zmax) {
-            status[i] = ParticleStatus::Y0Z1;
-          } else {
-            status[i] = ParticleStatus::Y0;
-          }
-        } else if (y[i] > ymax) {
-          if (z[i] < zmin) {
-            status[i] = ParticleStatus::Y1Z0;
-          } else if (z[i] > zmax) {
-            status[i] = ParticleStatus::Y1Z1;
-          } else {
-            status[i] = ParticleStatus::Y1;
-          }
-        } else {
-          if (z[i] < zmin) {
-            status[i] = ParticleStatus::Z0;
-          } else if (z[i] > zmax) {
-            status[i] = ParticleStatus::Z1;
-          }
+        total[d + 1] = sum;
+      }
+#pragma omp single
+      for (int d = 0; d < nbucket; ++d) {
+        total[d + 1] += total[d];
+      }
+#pragma omp for
+      for (int d = 0; d < nbucket; ++d) {
+        for (int t = 0; t < nteam; ++t) {
+          count[static_cast<std::size_t>(t) * nbucket + d] += total[d];
         }
       }
+
+      // Stable scatter of the slice
+      for (int i = lo; i < hi; ++i) {
+        const int j = hist[(key_cur[i] >> shift) & dmask]++;
+        key_tmp[j] = key_cur[i];
+        perm_tmp[j] = perm[i];
+      }
+#pragma omp barrier
+#pragma omp single
+      {
+        std::swap(key_cur, key_tmp);
+        std::swap(perm, perm_tmp);
+      }
+    }
+  }
+
+  // Move the particles data
+  PermuteParticles(particles, perm.data());
+}
+
+template <typename TX, typename TU>
+void SelectParticles(ParticlesT<TX, TU>& input, ParticlesT<TX, TU>& output,
+                     ParticleStatus status, bool remove) {
+  const int npar = input.npar();
+  const ParticleStatus* __restrict__ input_status = input.status();
+
+  // Mask the particles with the given status
+  std::vector<uint8_t> mask(npar);
+
+#pragma omp parallel for if (npar >= __LILIP_DEFAULT_OMPSIZE)
+  for (int i = 0; i < npar; ++i) {
+    mask[i] = HasStatus(input_status[i], status);
+  }
+
+  // Extract the particles and remove them in the same pass
+  CompactParticles(input, mask.data(), &output, remove);
+}
+
+namespace {
+/**
+ * @brief Branch-free boundary labelling kernel
+ *
+ * @tparam D Number of dimensions, the higher axes are never crossed
+ * @tparam T Type of the compared coordinate
+ * @tparam B Type of the domain bounds
+ * @param npar Number of particles
+ * @param x X-axis coordinate of the particles
+ * @param y Y-axis coordinate of the particles
+ * @param z Z-axis coordinate of the particles
+ * @param lo Lower bound of the domain in each axis
+ * @param hi Upper bound of the domain in each axis
+ * @param status Status of the particles
+ * @return std::array<int, 6> Number of particles crossing each boundary
+ * @details
+ * A particle crosses a boundary when its coordinate is strictly outside of
+ * `[lo, hi]`. The crossing flags are built from the compares and written
+ * without any branch, so that the loop is vectorized.
+ */
+template <int D, typename T, typename B>
+std::array<int, 6> LabelBoundaryKernel(int npar, const T* __restrict__ x,
+                                       const T* __restrict__ y,
+                                       const T* __restrict__ z,
+                                       std::array<B, 3> lo,
+                                       std::array<B, 3> hi,
+                                       ParticleStatus* __restrict__ status) {
+  const ParticleStatus keep = ~ParticleStatus(__LILIP_STATUS_CROSS_MASK);
+  int nx0 = 0, nx1 = 0, ny0 = 0, ny1 = 0, nz0 = 0, nz1 = 0;
+
+#pragma omp parallel for simd if (npar >= __LILIP_DEFAULT_OMPSIZE) \
+    reduction(+ : nx0, nx1, ny0, ny1, nz0, nz1)
+  for (int i = 0; i < npar; ++i) {
+    const bool cx0 = x[i] < lo[0];
+    const bool cx1 = x[i] > hi[0];
+    bool cy0 = false, cy1 = false, cz0 = false, cz1 = false;
+    if constexpr (D >= 2) {
+      cy0 = y[i] < lo[1];
+      cy1 = y[i] > hi[1];
+    }
+    if constexpr (D >= 3) {
+      cz0 = z[i] < lo[2];
+      cz1 = z[i] > hi[2];
     }
+
+    // Replace the crossing flags, keeping the tracked and out flags
+    status[i] = (status[i] & keep) | CrossStatus(cx0, cx1, cy0, cy1, cz0, cz1);
+
+    nx0 += cx0;
+    nx1 += cx1;
+    ny0 += cy0;
+    ny1 += cy1;
+    nz0 += cz0;
+    nz1 += cz1;
   }
+
+  return {nx0, nx1, ny0, ny1, nz0, nz1};
 }
 
-void PeriodicBoundaryParticles(Particles& particles, mesh::MeshSize mesh_size) {
+/**
+ * @brief Dispatch the boundary labelling kernel on the number of dimensions
+ *
+ * @param dim Number of dimensions
+ * @param args Arguments of LabelBoundaryKernel
+ */
+template <typename T, typename B, typename... Args>
+std::array<int, 6> LabelBoundaryDim(int dim, Args&&... args) {
+  switch (dim) {
+    case 1:
+      return LabelBoundaryKernel<1, T, B>(std::forward<Args>(args)...);
+    case 2:
+      return LabelBoundaryKernel<2, T, B>(std::forward<Args>(args)...);
+    default:
+      return LabelBoundaryKernel<3, T, B>(std::forward<Args>(args)...);
+  }
+}
+}  // namespace
+
+template <typename TX, typename TU>
+std::array<int, 6> LabelBoundaryParticles(ParticlesT<TX, TU>& particles,
+                                          mesh::MeshSize mesh_size) {
+  // The cell layout is labelled using the integer cell index
+  if (particles.layout() == input::PPosLayout::Cell) {
+    return LabelBoundaryDim<int, int>(
+        mesh_size.dim, particles.npar(), particles.ix(), particles.iy(),
+        particles.iz(), std::array<int, 3>{0, 0, 0},
+        std::array<int, 3>{mesh_size.nx - 1, mesh_size.ny - 1,
+                           mesh_size.nz - 1},
+        particles.status());
+  }
+
+  // Get the range of each dimension
+  return LabelBoundaryDim<TX, double>(
+      mesh_size.dim, particles.npar(), particles.x(), particles.y(),
+      particles.z(),
+      std::array<double, 3>{mesh_size.x0, mesh_size.y0, mesh_size.z0},
+      std::array<double, 3>{mesh_size.x0 + mesh_size.lx,
+                            mesh_size.y0 + mesh_size.ly,
+                            mesh_size.z0 + mesh_size.lz},
+      particles.status());
+}
+
+template <typename TX, typename TU>
+void PeriodicBoundaryParticles(ParticlesT<TX, TU>& particles,
+                               mesh::MeshSize mesh_size) {
+  const int npar = particles.npar();
+
   // Get the range of each dimension
   const double lx = mesh_size.lx;
   const double ly = mesh_size.ly;
@@ -564,12 +1497,40 @@ void PeriodicBoundaryParticles(Particles& particles, mesh::MeshSize mesh_size) {
   const double zmin = mesh_size.z0;
   const double zmax = mesh_size.z0 + lz;
 
-  double* __restrict__ x = particles.x();
-  double* __restrict__ y = particles.y();
-  double* __restrict__ z = particles.z();
+  // Wrap the cell index in the cell layout
+  if (particles.layout() == input::PPosLayout::Cell) {
+    int* __restrict__ ix = particles.ix();
+    int* __restrict__ iy = particles.iy();
+    int* __restrict__ iz = particles.iz();
+
+#pragma omp parallel for if (npar >= __LILIP_DEFAULT_OMPSIZE)
+    for (int i = 0; i < npar; ++i) {
+      if (ix[i] < 0) {
+        ix[i] += mesh_size.nx;
+      } else if (ix[i] >= mesh_size.nx) {
+        ix[i] -= mesh_size.nx;
+      }
+      if (iy[i] < 0) {
+        iy[i] += mesh_size.ny;
+      } else if (iy[i] >= mesh_size.ny) {
+        iy[i] -= mesh_size.ny;
+      }
+      if (iz[i] < 0) {
+        iz[i] += mesh_size.nz;
+      } else if (iz[i] >= mesh_size.nz) {
+        iz[i] -= mesh_size.nz;
+      }
+    }
+    return;
+  }
+
+  TX* __restrict__ x = particles.x();
+  TX* __restrict__ y = particles.y();
+  TX* __restrict__ z = particles.z();
 
   // Loop over particles and move them
-  for (int i = 0; i < particles.npar(); ++i) {
+#pragma omp parallel for if (npar >= __LILIP_DEFAULT_OMPSIZE)
+  for (int i = 0; i < npar; ++i) {
     if (x[i] < xmin) {
       x[i] += lx;
     } else if (x[i] > xmax) {
@@ -587,4 +1548,30 @@ void PeriodicBoundaryParticles(Particles& particles, mesh::MeshSize mesh_size) {
     }
   }
 }
+
+// Explicit instantiation for each supported precision
+#define __LILIP_INSTANTIATE(TX, TU)                                            \
+  template class ParticlesT<TX, TU>;                                           \
+  template void SaveParticles(ParticlesT<TX, TU>&, const char*);               \
+  template ParticlesT<TX, TU> LoadParticles(const char*);                      \
+  template void SaveParticles(ParticlesT<TX, TU>&, const char*, MPI_Comm);     \
+  template ParticlesT<TX, TU> LoadParticles(const char*, MPI_Comm);            \
+  template ParticlesT<TX, TU> LoadParticles(const char*, long, long);          \
+  template void StreamParticles(                                               \
+      const char*, long, long, int,                                            \
+      const std::function<void(ParticlesT<TX, TU>&, long)>&);                  \
+  template int CompactParticles(ParticlesT<TX, TU>&, const uint8_t*,           \
+                                ParticlesT<TX, TU>*, bool);                    \
+  template void PermuteParticles(ParticlesT<TX, TU>&, const int*);             \
+  template void SortParticlesByKey(ParticlesT<TX, TU>&, const uint64_t*);      \
+  template void SelectParticles(ParticlesT<TX, TU>&, ParticlesT<TX, TU>&,      \
+                                ParticleStatus, bool);                         \
+  template std::array<int, 6> LabelBoundaryParticles(ParticlesT<TX, TU>&,     \
+                                                     mesh::MeshSize);          \
+  template void PeriodicBoundaryParticles(ParticlesT<TX, TU>&, mesh::MeshSize);
+
+__LILIP_INSTANTIATE(double, double)
+__LILIP_INSTANTIATE(double, float)
+__LILIP_INSTANTIATE(float, float)
+#undef __LILIP_INSTANTIATE
 }  // namespace lili::particle
@@ -4,16 +4,50 @@
  */
 #pragma once
 
+#include <mpi.h>
+
 #include <algorithm>
+#include <array>
 #include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
 
 #include "input.hpp"
+#include "memory.hpp"
+#include "particle_status.hpp"
 
 #ifndef __LILIP_DEFAULT_BSIZE
 /**
- * @brief Default buffer size for the Particles class
+ * @brief Minimum buffer size for the Particles class
+ */
+#define __LILIP_DEFAULT_BSIZE 1024
+#endif
+
+#ifndef __LILIP_DEFAULT_HROOM
+/**
+ * @brief Default headroom divisor for the Particles class
+ *
+ * @details
+ * A buffer for `npar` particles is allocated with
+ * `npar / __LILIP_DEFAULT_HROOM` extra slots on top of it.
+ */
+#define __LILIP_DEFAULT_HROOM 8
+#endif
+
+#ifndef __LILIP_DEFAULT_OMPSIZE
+/**
+ * @brief Minimum number of particles to run the Particles routines with
+ * OpenMP threads
+ */
+#define __LILIP_DEFAULT_OMPSIZE 16384
+#endif
+
+#ifndef __LILIP_SORT_DBITS
+/**
+ * @brief Maximum number of bits per digit of the particle radix sort
  */
-#define __LILIP_DEFAULT_BSIZE 1000000
+#define __LILIP_SORT_DBITS 16
 #endif
 
 #ifndef __LILIP_DEFAULT_GSIZE
@@ -22,14 +56,43 @@
  */
 #define __LILIP_DEFAULT_GSIZE 2
 #endif
+
+#ifndef __LILIP_REAL_X
+/**
+ * @brief Floating point type of the particle positions
+ *
+ * @details
+ * Set through the `LILI_PARTICLE_PRECISION` CMake option.
+ */
+#define __LILIP_REAL_X double
+#endif
+
+#ifndef __LILIP_REAL_U
+/**
+ * @brief Floating point type of the particle velocities
+ *
+ * @details
+ * Set through the `LILI_PARTICLE_PRECISION` CMake option.
+ */
+#define __LILIP_REAL_U double
+#endif
 /**
  * @brief Number of unsigned long data in the Particles class
  */
 #define __LILIP_DCOUNT_ULONG 2
 /**
- * @brief Number of double data in the Particles class
+ * @brief Number of floating point data in the Particles class
+ */
+#define __LILIP_DCOUNT_REAL 6
+/**
+ * @brief Number of cell index data in the Particles class
  */
-#define __LILIP_DCOUNT_DOUBLE 6
+#define __LILIP_DCOUNT_CELL 3
+/**
+ * @brief Number of built-in data columns in the Particles class arena
+ */
+#define __LILIP_DCOUNT_COLUMN \
+  (__LILIP_DCOUNT_ULONG + __LILIP_DCOUNT_REAL + __LILIP_DCOUNT_CELL)
 
 /**
  * @brief Namespace for LILI particle related routines
@@ -41,95 +104,124 @@ namespace lili::particle {
  */
 extern const char* __LILIP_DNAME_UINT32[];
 /**
- * @brief Default names for the double data
+ * @brief Default names for the floating point data
+ */
+extern const char* __LILIP_DNAME_REAL[];
+/**
+ * @brief Default names for the cell index data
  */
-extern const char* __LILIP_DNAME_DOUBLE[];
+extern const char* __LILIP_DNAME_CELL[];
 
 /**
- * @brief Enumeration class for the particle status
+ * @brief Enumeration class for the element type of a particle column
+ */
+enum class ColumnType {
+  UInt8,    ///< 8-bit unsigned integer
+  Int32,    ///< 32-bit signed integer
+  UInt64,   ///< 64-bit unsigned integer
+  Float32,  ///< Single precision floating point
+  Float64   ///< Double precision floating point
+};
+
+/**
+ * @brief Element size of a column type in bytes
  *
- * @details
- * This enumeration class is useful to flag the particle and can be extended
- * further. Currently it tracks whether the particle is tracked or not and
- * whether it has crossed the boundary or not.
- */
-enum class ParticleStatus {
-  Out,      ///< Out of domain, to be removed
-  In,       ///< Inside the domain
-  Tracked,  ///< Tracked, inside the domain
-  X0,       ///< Crossed the -X boundary
-  X1,       ///< Crossed the +X boundary
-  Y0,       ///< Crossed the -Y boundary
-  Y1,       ///< Crossed the +Y boundary
-  Z0,       ///< Crossed the -Z boundary
-  Z1,       ///< Crossed the +Z boundary
-  X0Y0,     ///< Crossed the -X and -Y boundary
-  X0Y1,     ///< Crossed the -X and +Y boundary
-  X1Y0,     ///< Crossed the +X and -Y boundary
-  X1Y1,     ///< Crossed the +X and +Y boundary
-  X0Z0,     ///< Crossed the -X and -Z boundary
-  X0Z1,     ///< Crossed the -X and +Z boundary
-  X1Z0,     ///< Crossed the +X and -Z boundary
-  X1Z1,     ///< Crossed the +X and +Z boundary
-  Y0Z0,     ///< Crossed the -Y and -Z boundary
-  Y0Z1,     ///< Crossed the -Y and +Z boundary
-  Y1Z0,     ///< Crossed the +Y and -Z boundary
-  Y1Z1,     ///< Crossed the +Y and +Z boundary
-  X0Y0Z0,   ///< Crossed the -X, -Y, and -Z boundary
-  X0Y0Z1,   ///< Crossed the -X, -Y, and +Z boundary
-  X0Y1Z0,   ///< Crossed the -X, +Y, and -Z boundary
-  X0Y1Z1,   ///< Crossed the -X, +Y, and +Z boundary
-  X1Y0Z0,   ///< Crossed the +X, -Y, and -Z boundary
-  X1Y0Z1,   ///< Crossed the +X, -Y, and +Z boundary
-  X1Y1Z0,   ///< Crossed the +X, +Y, and -Z boundary
-  X1Y1Z1,   ///< Crossed the +X, +Y, and +Z boundary
-  TX0,      ///< Tracked, crossed the -X boundary
-  TX1,      ///< Tracked, crossed the +X boundary
-  TY0,      ///< Tracked, crossed the -Y boundary
-  TY1,      ///< Tracked, crossed the +Y boundary
-  TZ0,      ///< Tracked, crossed the -Z boundary
-  TZ1,      ///< Tracked, crossed the +Z boundary
-  TX0Y0,    ///< Tracked, crossed the -X and -Y boundary
-  TX0Y1,    ///< Tracked, crossed the -X and +Y boundary
-  TX1Y0,    ///< Tracked, crossed the +X and -Y boundary
-  TX1Y1,    ///< Tracked, crossed the +X and +Y boundary
-  TX0Z0,    ///< Tracked, crossed the -X and -Z boundary
-  TX0Z1,    ///< Tracked, crossed the -X and +Z boundary
-  TX1Z0,    ///< Tracked, crossed the +X and -Z boundary
-  TX1Z1,    ///< Tracked, crossed the +X and +Z boundary
-  TY0Z0,    ///< Tracked, crossed the -Y and -Z boundary
-  TY0Z1,    ///< Tracked, crossed the -Y and +Z boundary
-  TY1Z0,    ///< Tracked, crossed the +Y and -Z boundary
-  TY1Z1,    ///< Tracked, crossed the +Y and +Z boundary
-  TX0Y0Z0,  ///< Tracked, crossed the -X, -Y, and -Z boundary
-  TX0Y0Z1,  ///< Tracked, crossed the -X, -Y, and +Z boundary
-  TX0Y1Z0,  ///< Tracked, crossed the -X, +Y, and -Z boundary
-  TX0Y1Z1,  ///< Tracked, crossed the -X, +Y, and +Z boundary
-  TX1Y0Z0,  ///< Tracked, crossed the +X, -Y, and -Z boundary
-  TX1Y0Z1,  ///< Tracked, crossed the +X, -Y, and +Z boundary
-  TX1Y1Z0,  ///< Tracked, crossed the +X, +Y, and -Z boundary
-  TX1Y1Z1   ///< Tracked, crossed the +X, +Y, and +Z boundary
+ * @param type Column type
+ * @return std::size_t Element size
+ */
+constexpr std::size_t ColumnTypeSize(ColumnType type) {
+  switch (type) {
+    case ColumnType::UInt8:
+      return 1;
+    case ColumnType::Int32:
+    case ColumnType::Float32:
+      return 4;
+    default:
+      return 8;
+  }
+}
+
+/**
+ * @brief Description of an extra particle column
+ */
+struct ParticleColumn {
+  std::string name;  ///< Column name, also used in the HDF5 file
+  ColumnType type;   ///< Element type
+
+  /// @cond OPERATORS
+  bool operator==(const ParticleColumn& other) const {
+    return name == other.name && type == other.type;
+  }
+  /// @endcond
 };
 
+/**
+ * @brief Function to get the buffer size for a given number of particles
+ *
+ * @param npar Number of particles
+ * @return int Buffer size
+ * @details
+ * The buffer size is the number of particles with a headroom of
+ * `npar / __LILIP_DEFAULT_HROOM`, at least `__LILIP_DEFAULT_BSIZE`, and
+ * rounded up to a multiple of `__LILI_ALIGNMENT` so that every column in the
+ * arena starts at an aligned address.
+ */
+int ParticlesCapacity(int npar);
+
 /**
  * @brief Class to store particles data of a single species
+ *
+ * @tparam TX Floating point type of the positions
+ * @tparam TU Floating point type of the velocities
+ * @details
+ * All of the data columns are stored in a single aligned memory::Arena block
+ * with the layout `id | status | x | y | z | u | v | w | ix | iy | iz`,
+ * followed by the extra columns registered with AddColumn. Each column holds
+ * `npar_max` entries and starts at a `__LILI_ALIGNMENT` aligned address.
+ *
+ * The extra columns (e.g. a weight or a cached Lorentz factor) are moved by
+ * every generic routine (resize, compaction, sorting, and I/O), while the
+ * kernels that do not use them never touch their memory.
+ *
+ * The positions are stored either in the physical coordinate
+ * (input::PPosLayout::Physical) or as a cell index `ix`, `iy`, `iz` and an
+ * in-cell offset \f$ x \in [0, 1) \f$ in the grid unit of `grid()`
+ * (input::PPosLayout::Cell). The cell index columns are empty in the physical
+ * layout.
+ *
+ * The class is instantiated for `<double, double>`, `<double, float>`, and
+ * `<float, float>`. The Particles type used by the simulation is selected at
+ * build time with `__LILIP_REAL_X` and `__LILIP_REAL_U`.
  */
-class Particles {
+template <typename TX = __LILIP_REAL_X, typename TU = __LILIP_REAL_U>
+class ParticlesT {
  public:
+  using RealX = TX;  ///< Floating point type of the positions
+  using RealU = TU;  ///< Floating point type of the velocities
+
   // Constructor
-  Particles();
-  Particles(int npar);
-  Particles(int npar, int npar_max);
-  Particles(input::InputParticles input_particle);
+  ParticlesT();
+  ParticlesT(int npar);
+  ParticlesT(int npar, int npar_max);
+  ParticlesT(const input::InputParticles& input_particle);
 
   // Copy constructor
-  Particles(const Particles& other);
+  ParticlesT(const ParticlesT& other);
 
-  // Move constructor
-  Particles(Particles&& other) noexcept : Particles() { swap(*this, other); };
+  /**
+   * @brief Move constructor
+   *
+   * @details
+   * The default constructed object has no arena, so the move does not
+   * allocate: `other` is left empty, with `npar_max() == 0`, until its next
+   * Reserve.
+   */
+  ParticlesT(ParticlesT&& other) noexcept : ParticlesT() {
+    swap(*this, other);
+  };
 
   // Destructor
-  ~Particles();
+  ~ParticlesT();
 
   /**
    * @brief Function to swap the data between two Particles objects
@@ -140,7 +232,7 @@ class Particles {
    * This function will swap the data between two Particles objects in-place
    * using std::swap.
    */
-  friend void swap(Particles& first, Particles& second) noexcept {
+  friend void swap(ParticlesT& first, ParticlesT& second) noexcept {
     using std::swap;
     swap(first.npar_, second.npar_);
     swap(first.npar_max_, second.npar_max_);
@@ -148,6 +240,11 @@ class Particles {
     swap(first.q_, second.q_);
     swap(first.m_, second.m_);
 
+    swap(first.layout_, second.layout_);
+    swap(first.grid_, second.grid_);
+    swap(first.columns_, second.columns_);
+
+    swap(first.arena_, second.arena_);
     swap(first.id_, second.id_);
     swap(first.status_, second.status_);
 
@@ -157,11 +254,15 @@ class Particles {
     swap(first.u_, second.u_);
     swap(first.v_, second.v_);
     swap(first.w_, second.w_);
+
+    swap(first.ix_, second.ix_);
+    swap(first.iy_, second.iy_);
+    swap(first.iz_, second.iz_);
   }
 
   // Operators
   /// @cond OPERATORS
-  Particles& operator=(Particles other) {
+  ParticlesT& operator=(ParticlesT other) {
     swap(*this, other);
     return *this;
   }
@@ -175,23 +276,34 @@ class Particles {
   constexpr double q() const { return q_; };
   constexpr double m() const { return m_; };
 
+  constexpr input::PPosLayout layout() const { return layout_; };
+  constexpr const mesh::MeshSize& grid() const { return grid_; };
+  const std::vector<ParticleColumn>& columns() const { return columns_; };
+  int ncolumn() const { return __LILIP_DCOUNT_COLUMN + columns_.size(); };
+
   constexpr ulong* id() const { return id_; };
   constexpr ParticleStatus* status() const { return status_; };
-  constexpr double* x() const { return x_; };
-  constexpr double* y() const { return y_; };
-  constexpr double* z() const { return z_; };
-  constexpr double* u() const { return u_; };
-  constexpr double* v() const { return v_; };
-  constexpr double* w() const { return w_; };
+  constexpr TX* x() const { return x_; };
+  constexpr TX* y() const { return y_; };
+  constexpr TX* z() const { return z_; };
+  constexpr TU* u() const { return u_; };
+  constexpr TU* v() const { return v_; };
+  constexpr TU* w() const { return w_; };
+  constexpr int* ix() const { return ix_; };
+  constexpr int* iy() const { return iy_; };
+  constexpr int* iz() const { return iz_; };
 
   constexpr ulong id(int i) const { return id_[i]; };
   constexpr ParticleStatus status(int i) const { return status_[i]; };
-  constexpr double x(int i) const { return x_[i]; };
-  constexpr double y(int i) const { return y_[i]; };
-  constexpr double z(int i) const { return z_[i]; };
-  constexpr double u(int i) const { return u_[i]; };
-  constexpr double v(int i) const { return v_[i]; };
-  constexpr double w(int i) const { return w_[i]; };
+  constexpr TX x(int i) const { return x_[i]; };
+  constexpr TX y(int i) const { return y_[i]; };
+  constexpr TX z(int i) const { return z_[i]; };
+  constexpr TU u(int i) const { return u_[i]; };
+  constexpr TU v(int i) const { return v_[i]; };
+  constexpr TU w(int i) const { return w_[i]; };
+  constexpr int ix(int i) const { return ix_[i]; };
+  constexpr int iy(int i) const { return iy_[i]; };
+  constexpr int iz(int i) const { return iz_[i]; };
   /// @endcond
 
   // Setters
@@ -203,80 +315,137 @@ class Particles {
 
   constexpr ulong& id(int i) { return id_[i]; };
   constexpr ParticleStatus& status(int i) { return status_[i]; };
-  constexpr double& x(int i) { return x_[i]; };
-  constexpr double& y(int i) { return y_[i]; };
-  constexpr double& z(int i) { return z_[i]; };
-  constexpr double& u(int i) { return u_[i]; };
-  constexpr double& v(int i) { return v_[i]; };
-  constexpr double& w(int i) { return w_[i]; };
+  constexpr TX& x(int i) { return x_[i]; };
+  constexpr TX& y(int i) { return y_[i]; };
+  constexpr TX& z(int i) { return z_[i]; };
+  constexpr TU& u(int i) { return u_[i]; };
+  constexpr TU& v(int i) { return v_[i]; };
+  constexpr TU& w(int i) { return w_[i]; };
+  constexpr int& ix(int i) { return ix_[i]; };
+  constexpr int& iy(int i) { return iy_[i]; };
+  constexpr int& iz(int i) { return iz_[i]; };
   /// @endcond
 
-  // Data pointers for HDF5
+  /// @cond POSITIONS
   /**
-   * @brief Helper function to iterate over ulong data arrays for HDF5 output
+   * @brief Physical coordinate of a particle, independent of the layout
    *
-   * @param i Index of the data array
-   * @return constexpr ulong* Pointer to the data array
-   * @details
-   * Currently the index `i` represents the following data arrays:
-   * | `i` | Data array | Description |
-   * | :-: | :-: | :- |
-   * | 0 | `id` | Particle ID |
-   * | 1 | `status` | Particle status |
+   * @param i Index of the particle
    */
-  constexpr ulong* data_uint32(int i) {
-    switch (i) {
-      case 0:
-        return id_;
-      case 1:
-        return reinterpret_cast<ulong*>(status_);
-      default:
-        return nullptr;
+  double PhysicalX(int i) const {
+    if (layout_ == input::PPosLayout::Cell) {
+      return grid_.x0 + (ix_[i] + static_cast<double>(x_[i])) * grid_.lx /
+                            grid_.nx;
+    }
+    return x_[i];
+  };
+  double PhysicalY(int i) const {
+    if (layout_ == input::PPosLayout::Cell) {
+      return grid_.y0 + (iy_[i] + static_cast<double>(y_[i])) * grid_.ly /
+                            grid_.ny;
+    }
+    return y_[i];
+  };
+  double PhysicalZ(int i) const {
+    if (layout_ == input::PPosLayout::Cell) {
+      return grid_.z0 + (iz_[i] + static_cast<double>(z_[i])) * grid_.lz /
+                            grid_.nz;
     }
+    return z_[i];
   };
+  /// @endcond
 
   /**
-   * @brief Helper function to iterate over double data arrays for HDF5 output
+   * @brief Convert the particle positions to a given layout
    *
-   * @param i Index of the data array
-   * @return constexpr double* Pointer to the data array
+   * @param layout New position layout
+   * @param grid Mesh the cell index and offset refer to
    * @details
-   * Currently the index `i` represents the following data arrays:
-   * | `i` | Data array | Description |
-   * | :-: | :-: | :- |
-   * | 0 | `x` | Particle \f$x_i\f$ coordinate |
-   * | 1 | `y` | Particle \f$y_i\f$ coordinate |
-   * | 2 | `z` | Particle \f$z_i\f$ coordinate |
-   * | 3 | `u` | Particle \f$v_{x, i}\f$ velocity |
-   * | 4 | `v` | Particle \f$v_{y, i}\f$ velocity |
-   * | 5 | `w` | Particle \f$v_{z, i}\f$ velocity |
+   * Converting to input::PPosLayout::Cell splits the physical coordinate into
+   * the cell index and the in-cell offset on `grid`. Converting back to
+   * input::PPosLayout::Physical recovers the physical coordinate and drops the
+   * cell index columns. The arena is reallocated when the layout changes.
    */
-  constexpr double* data_double(int i) {
-    switch (i) {
-      case 0:
-        return x_;
-      case 1:
-        return y_;
-      case 2:
-        return z_;
-      case 3:
-        return u_;
-      case 4:
-        return v_;
-      case 5:
-        return w_;
-      default:
-        return nullptr;
-    }
-  };
+  void SetLayout(input::PPosLayout layout, const mesh::MeshSize& grid);
+
+  /**
+   * @brief Register an extra column
+   *
+   * @param name Column name
+   * @param type Element type
+   * @return int Index of the column in the arena
+   * @details
+   * The arena is reallocated and the new column is set to zero. Nothing is
+   * changed if a column with the same name and type already exists, and the
+   * simulation exits if the name is taken by another column.
+   */
+  int AddColumn(const std::string& name, ColumnType type);
+
+  /**
+   * @brief Set the extra columns
+   *
+   * @param columns Extra columns
+   * @details
+   * The columns of `columns` that already exist keep their data, the other
+   * extra columns are dropped and the new ones are set to zero.
+   */
+  void SetColumns(const std::vector<ParticleColumn>& columns);
+
+  /**
+   * @brief Index of a column from its name
+   *
+   * @param name Column name
+   * @return int Index of the column in the arena, -1 if not found
+   */
+  int FindColumn(const std::string& name) const;
+
+  /**
+   * @brief Name of a column
+   *
+   * @param icol Index of the column in the arena
+   */
+  const char* ColumnName(int icol) const;
+
+  /**
+   * @brief Element type of a column
+   *
+   * @param icol Index of the column in the arena
+   */
+  ColumnType ColumnTypeOf(int icol) const;
 
   /**
    * @brief Resize the size of data arrays
    *
    * @param new_npar_max New maximum number of particles
+   * @details
+   * Only the `npar` live particles are moved, the new tail is left
+   * uninitialized. Large arenas are grown in place using `mremap`, in which
+   * case no data is copied to a second buffer.
    */
   void resize(int new_npar_max);
 
+  /**
+   * @brief Make sure the data arrays can hold at least `npar` particles
+   *
+   * @param npar Number of particles
+   * @details
+   * Grow the data arrays by at least `__LILIP_DEFAULT_GSIZE` if needed. An
+   * empty object, default constructed or moved from, allocates its arena
+   * here.
+   */
+  void Reserve(int npar);
+
+  /**
+   * @brief Copy the live particles of another object into this object
+   *
+   * @param other Other Particles object
+   * @details
+   * Unlike the copy assignment, the arena is reused when it can hold the
+   * particles of `other` with the same columns and layout, so that a staging
+   * buffer can be refilled periodically without any allocation.
+   */
+  void CopyFrom(const ParticlesT& other);
+
   /**
    * @brief Add an integer offset to the particle ID
    *
@@ -295,50 +464,299 @@ class Particles {
   /**
    * @brief Function to clean up particles that are outside of the domain with
    * ParticleStatus::Out status.
+   *
+   * @details
+   * The order of the remaining particles is preserved.
    */
   void CleanOut();
 
+  /**
+   * @brief Pointer to the start of a data column in the arena
+   *
+   * @param icol Index of the column in the arena
+   * @return void* Pointer to the data column
+   * @details
+   * The columns are ordered as `id`, `status`, `x`, `y`, `z`, `u`, `v`, `w`,
+   * `ix`, `iy`, `iz`, and the extra columns. The element type of each column
+   * is given by ColumnTypeOf.
+   */
+  void* column(int icol) {
+    return static_cast<char*>(arena_.data()) + ColumnOffset(icol, npar_max_);
+  };
+  const void* column(int icol) const {
+    return static_cast<const char*>(arena_.data()) +
+           ColumnOffset(icol, npar_max_);
+  };
+
+  /**
+   * @brief Typed pointer to the start of a data column
+   *
+   * @tparam T Element type of the column
+   * @param icol Index of the column in the arena
+   */
+  template <typename T>
+  T* column(int icol) {
+    return static_cast<T*>(column(icol));
+  };
+
+  /**
+   * @brief Element size of a column in the arena
+   *
+   * @param icol Index of the column in the arena
+   * @details
+   * The cell index columns have zero size in the physical layout.
+   */
+  std::size_t ColumnSize(int icol) const;
+
  private:
   int npar_, npar_max_;
   double q_, m_;
 
+  input::PPosLayout layout_;  // Position layout
+  mesh::MeshSize grid_;       // Mesh for the cell layout
+
+  std::vector<ParticleColumn> columns_;  // Extra columns
+
+  /**
+   * @brief Offset of a column from the start of the arena
+   *
+   * @param icol Index of the column in the arena
+   * @param npar_max Number of particles per column
+   */
+  std::size_t ColumnOffset(int icol, int npar_max) const;
+
+  /**
+   * @brief Total size of the arena for `npar_max` particles
+   *
+   * @param npar_max Number of particles per column
+   */
+  std::size_t ArenaBytes(int npar_max) const;
+
+  /**
+   * @brief Allocate the arena for `npar_max_` particles and map the columns
+   */
+  void AllocateArena();
+
+  /**
+   * @brief Set the column pointers based on the arena and `npar_max_`
+   */
+  void MapColumns();
+
+  /**
+   * @brief Initialize the first `npar_` particles to zero with
+   * ParticleStatus::In status
+   */
+  void InitializeData();
+
+  memory::Arena arena_;  // Memory block for all of the columns
+
   ulong* id_;
   ParticleStatus* status_;
 
-  double *x_, *y_, *z_;
-  double *u_, *v_, *w_;
+  TX *x_, *y_, *z_;
+  TU *u_, *v_, *w_;
+
+  int *ix_, *iy_, *iz_;
 };
 
-void SaveParticles(Particles& particles, const char* file_name);
+/**
+ * @brief Particles type used by the simulation
+ */
+using Particles = ParticlesT<>;
+
+/**
+ * @brief Function to save particle data to HDF5 file
+ *
+ * @param particles Particles object
+ * @param file_name Name of the file to save to
+ * @details
+ * Each column is stored with its in-memory type, i.e. the positions and
+ * velocities are stored as `float` for single precision particles. The
+ * positions are always stored in the physical coordinate, converted to
+ * `double` for the input::PPosLayout::Cell layout.
+ */
+template <typename TX, typename TU>
+void SaveParticles(ParticlesT<TX, TU>& particles, const char* file_name);
+
+/**
+ * @brief Function to save the particle data of all ranks to a single HDF5
+ * file using collective MPI-IO
+ *
+ * @param particles Particles object of the current rank
+ * @param file_name Name of the file to save to
+ * @param comm MPI communicator of the ranks writing the file
+ * @details
+ * Each rank writes its particles as a contiguous slice of every dataset,
+ * starting at the `MPI_Exscan` of the number of particles. All of the ranks
+ * must have the same extra columns. HDF5 needs to be built with parallel
+ * support for more than one rank.
+ */
+template <typename TX, typename TU>
+void SaveParticles(ParticlesT<TX, TU>& particles, const char* file_name,
+                   MPI_Comm comm);
 
 /**
  * @brief Function to load particle data from HDF5 file
  *
+ * @tparam TX Floating point type of the positions
+ * @tparam TU Floating point type of the velocities
+ * @param file_name Name of the file to load from
+ *
+ * @return ParticlesT<TX, TU> Particles object
+ * @details
+ * The data is converted by HDF5 if the file is stored in a different
+ * precision. The particles are loaded in the input::PPosLayout::Physical
+ * layout.
+ */
+template <typename TX = __LILIP_REAL_X, typename TU = __LILIP_REAL_U>
+ParticlesT<TX, TU> LoadParticles(const char* file_name);
+
+/**
+ * @brief Function to load a range of the particle data from HDF5 file
+ *
+ * @tparam TX Floating point type of the positions
+ * @tparam TU Floating point type of the velocities
  * @param file_name Name of the file to load from
+ * @param start Index of the first particle to load
+ * @param count Number of particles to load, negative to load until the end
+ * @return ParticlesT<TX, TU> Particles object
+ * @details
+ * Only the selected range is read from the file, e.g. to seed a test particle
+ * run with a subset of a previous dump. The range is clamped to the particles
+ * in the file, and the Particles object is sized for the range.
+ */
+template <typename TX = __LILIP_REAL_X, typename TU = __LILIP_REAL_U>
+ParticlesT<TX, TU> LoadParticles(const char* file_name, long start,
+                                 long count);
+
+/**
+ * @brief Function to stream a range of the particle data from HDF5 file in
+ * fixed-size chunks
  *
- * @return Particles Particles object
+ * @tparam TX Floating point type of the positions
+ * @tparam TU Floating point type of the velocities
+ * @param file_name Name of the file to load from
+ * @param start Index of the first particle to load
+ * @param count Number of particles to load, negative to load until the end
+ * @param chunk Maximum number of particles per chunk
+ * @param process Function called on each chunk with the index of its first
+ * particle in the file
+ * @details
+ * A single buffer of `chunk` particles is reused for every chunk, so that the
+ * memory used does not depend on the number of particles in the file.
  */
-Particles LoadParticles(const char* file_name);
+template <typename TX = __LILIP_REAL_X, typename TU = __LILIP_REAL_U>
+void StreamParticles(
+    const char* file_name, long start, long count, int chunk,
+    const std::function<void(ParticlesT<TX, TU>&, long)>& process);
+
+/**
+ * @brief Function to get the number of particles in a HDF5 file
+ *
+ * @param file_name Name of the particle file
+ * @return long Number of particles in the file
+ */
+long CountParticles(const char* file_name);
+
+/**
+ * @brief Function to load a slice of the particle data from a single HDF5
+ * file using collective MPI-IO
+ *
+ * @tparam TX Floating point type of the positions
+ * @tparam TU Floating point type of the velocities
+ * @param file_name Name of the file to load from
+ * @param comm MPI communicator of the ranks reading the file
+ * @return ParticlesT<TX, TU> Particles object of the current rank
+ * @details
+ * The datasets are split into contiguous slices of nearly equal size, one per
+ * rank, so the file can be read with a different number of ranks than it was
+ * written with.
+ */
+template <typename TX = __LILIP_REAL_X, typename TU = __LILIP_REAL_U>
+ParticlesT<TX, TU> LoadParticles(const char* file_name, MPI_Comm comm);
+
+/**
+ * @brief Function to do a stable stream compaction of particles
+ *
+ * @param particles Particles object
+ * @param mask Mask for each particle, non-zero for the selected particles
+ * @param output Particles object to store the selected particles, can be
+ * `nullptr`
+ * @param remove Whether to remove the selected particles from `particles`
+ * @return int Number of selected particles
+ * @details
+ * The compaction is done in a single pass with OpenMP threads: each thread
+ * counts the selected particles in its chunk, the counts are scanned into
+ * offsets, and each column is scattered to `output` and to a scratch column
+ * for the remaining particles. The order of both the selected and the
+ * remaining particles is preserved.
+ */
+template <typename TX, typename TU>
+int CompactParticles(ParticlesT<TX, TU>& particles, const uint8_t* mask,
+                     ParticlesT<TX, TU>* output, bool remove);
+
+/**
+ * @brief Function to reorder the particles data
+ *
+ * @param particles Particles object
+ * @param perm Permutation of the particles, the new particle `i` is the old
+ * particle `perm[i]`
+ */
+template <typename TX, typename TU>
+void PermuteParticles(ParticlesT<TX, TU>& particles, const int* perm);
+
+/**
+ * @brief Function to sort particles based on a given key
+ *
+ * @param particles Particles object
+ * @param key Sort key for each particle
+ * @details
+ * The particles are sorted using a stable least significant digit radix sort
+ * on the key, with the number of passes chosen from the largest key so that
+ * small key ranges (e.g. cell indices) are sorted with a single counting sort
+ * pass. The data columns are then moved once using PermuteParticles.
+ */
+template <typename TX, typename TU>
+void SortParticlesByKey(ParticlesT<TX, TU>& particles, const uint64_t* key);
 
 /**
  * @brief Function to select particles based on its status
  *
  * @param input Input particles
  * @param output Output particles
- * @param status Status to select
+ * @param status Status flags to select, a particle is selected if all of the
+ * flags are set
  * @param remove Whether to remove the selected particles from the input
  * particles
+ * @details
+ * The selected particles are extracted and removed in the same pass using
+ * CompactParticles.
  */
-void SelectParticles(Particles& input, Particles& output, ParticleStatus status,
-                     bool remove = false);
+template <typename TX, typename TU>
+void SelectParticles(ParticlesT<TX, TU>& input, ParticlesT<TX, TU>& output,
+                     ParticleStatus status, bool remove = false);
 
 /**
  * @brief Function to label particles that are out of bounds
  *
  * @param particles Particles object
  * @param mesh_size MeshSize object containing the domain size
+ * @return std::array<int, 6> Number of particles crossing each boundary, in
+ * the order `X0`, `X1`, `Y0`, `Y1`, `Z0`, `Z1`
+ * @details
+ * The crossing flags of each particle are replaced by the boundaries it has
+ * crossed, the other flags are kept. In the input::PPosLayout::Cell layout
+ * only the integer cell index is compared with the number of cells in
+ * `mesh_size`.
+ *
+ * The kernel is branch-free and specialised at compile time on
+ * `mesh_size.dim`, the axes above the dimension of the mesh are never
+ * labelled. The counts can be used to size the exchange buffers without a
+ * second pass over the particles.
  */
-void LabelBoundaryParticles(Particles& particles, mesh::MeshSize mesh_size);
+template <typename TX, typename TU>
+std::array<int, 6> LabelBoundaryParticles(ParticlesT<TX, TU>& particles,
+                                          mesh::MeshSize mesh_size);
 
 /**
  * @brief Function to move particle positions assuming periodic boundaries
@@ -346,7 +764,12 @@ void LabelBoundaryParticles(Particles& particles, mesh::MeshSize mesh_size);
  *
  * @param particles Particles object
  * @param mesh_size Mesh size
+ * @details
+ * In the input::PPosLayout::Cell layout only the integer cell index is
+ * wrapped, the in-cell offset is unchanged.
  */
-void PeriodicBoundaryParticles(Particles& particles, mesh::MeshSize mesh_size);
+template <typename TX, typename TU>
+void PeriodicBoundaryParticles(ParticlesT<TX, TU>& particles,
+                               mesh::MeshSize mesh_size);
 
 }  // namespace lili::particle
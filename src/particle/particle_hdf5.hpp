@@ -0,0 +1,48 @@
+/**
+ * @file particle_hdf5.hpp
+ * @brief Header only helpers to map particle data types to HDF5 types
+ */
+#pragma once
+
+#include <cstdint>
+#include <sys/types.h>
+
+#include "hdf5.h"
+
+namespace lili::particle {
+/**
+ * @brief HDF5 native type of a C++ type
+ *
+ * @tparam T C++ type
+ * @return hid_t HDF5 native type
+ */
+template <typename T>
+hid_t H5NativeType();
+
+/// @cond H5TYPES
+template <>
+inline hid_t H5NativeType<float>() {
+  return H5T_NATIVE_FLOAT;
+}
+template <>
+inline hid_t H5NativeType<double>() {
+  return H5T_NATIVE_DOUBLE;
+}
+template <>
+inline hid_t H5NativeType<uint8_t>() {
+  return H5T_NATIVE_UINT8;
+}
+template <>
+inline hid_t H5NativeType<int32_t>() {
+  return H5T_NATIVE_INT32;
+}
+template <>
+inline hid_t H5NativeType<uint32_t>() {
+  return H5T_NATIVE_UINT32;
+}
+template <>
+inline hid_t H5NativeType<ulong>() {
+  return H5T_NATIVE_ULONG;
+}
+/// @endcond
+}  // namespace lili::particle
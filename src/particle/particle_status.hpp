@@ -0,0 +1,279 @@
+/**
+ * @file particle_status.hpp
+ * @brief Header only library for the particle status bit flags
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace lili::particle {
+/**
+ * @brief Enumeration class for the particle status
+ *
+ * @details
+ * The status is a single byte of bit flags. The lower two bits flag whether
+ * the particle is tracked and whether it is out of the domain and has to be
+ * removed. The upper six bits hold two bits per axis for the boundary the
+ * particle has crossed, in the order `X0 X1 Y0 Y1 Z0 Z1`. A particle inside
+ * the domain that is not tracked has no flag set. The flags are combined with
+ * the bitwise operators, e.g. `ParticleStatus::Tracked | ParticleStatus::X1`.
+ *
+ * ParticleStatus::In is the empty flag set, not a flag: a particle is in the
+ * domain when its ParticleStatus::Out flag is not set, which is tested with
+ * IsIn. The values differ from the enumeration of the files written before
+ * the flag set, which are converted with LegacyStatus when loaded.
+ */
+enum class ParticleStatus : uint8_t {
+  In = 0,            ///< No flag set, use IsIn to test for the domain
+  Tracked = 1 << 0,  ///< Tracked
+  Out = 1 << 1,      ///< Out of domain, to be removed
+  X0 = 1 << 2,       ///< Crossed the -X boundary
+  X1 = 1 << 3,       ///< Crossed the +X boundary
+  Y0 = 1 << 4,       ///< Crossed the -Y boundary
+  Y1 = 1 << 5,       ///< Crossed the +Y boundary
+  Z0 = 1 << 6,       ///< Crossed the -Z boundary
+  Z1 = 1 << 7        ///< Crossed the +Z boundary
+};
+
+#ifndef __LILIP_STATUS_FORMAT
+/**
+ * @brief Version of the status values stored in the particle files
+ *
+ * @details
+ * Written as the `status_format` attribute of the particle files. Files
+ * without the attribute use the legacy enumeration, see LegacyStatus.
+ */
+#define __LILIP_STATUS_FORMAT 1
+#endif
+
+/**
+ * @brief Bit position of the crossing flags of the X-axis
+ */
+#define __LILIP_STATUS_CROSS_SHIFT 2
+
+/**
+ * @brief Mask of all of the boundary crossing flags
+ */
+#define __LILIP_STATUS_CROSS_MASK 0xfc
+
+/// @cond STATUS_OPERATORS
+constexpr ParticleStatus operator|(ParticleStatus a, ParticleStatus b) {
+  return static_cast<ParticleStatus>(static_cast<uint8_t>(a) |
+                                     static_cast<uint8_t>(b));
+}
+constexpr ParticleStatus operator&(ParticleStatus a, ParticleStatus b) {
+  return static_cast<ParticleStatus>(static_cast<uint8_t>(a) &
+                                     static_cast<uint8_t>(b));
+}
+constexpr ParticleStatus operator~(ParticleStatus a) {
+  return static_cast<ParticleStatus>(~static_cast<uint8_t>(a));
+}
+constexpr ParticleStatus& operator|=(ParticleStatus& a, ParticleStatus b) {
+  return a = a | b;
+}
+constexpr ParticleStatus& operator&=(ParticleStatus& a, ParticleStatus b) {
+  return a = a & b;
+}
+/// @endcond
+
+/**
+ * @brief Check whether a status has all of the given flags set
+ *
+ * @param status Particle status
+ * @param flags Flags to check
+ * @return bool Whether all of `flags` are set in `status`
+ */
+constexpr bool HasStatus(ParticleStatus status, ParticleStatus flags) {
+  return (status & flags) == flags;
+}
+
+/**
+ * @brief Check whether a particle is inside the domain
+ *
+ * @param status Particle status
+ * @return bool Whether the ParticleStatus::Out flag is not set
+ * @details
+ * `HasStatus(status, ParticleStatus::In)` is always true, since
+ * ParticleStatus::In has no bit set.
+ */
+constexpr bool IsIn(ParticleStatus status) {
+  return !HasStatus(status, ParticleStatus::Out);
+}
+
+/**
+ * @brief Boundary crossing flags of a status
+ *
+ * @param status Particle status
+ * @return ParticleStatus Status with only the crossing flags kept
+ */
+constexpr ParticleStatus CrossStatus(ParticleStatus status) {
+  return static_cast<ParticleStatus>(static_cast<uint8_t>(status) &
+                                     __LILIP_STATUS_CROSS_MASK);
+}
+
+/**
+ * @brief Boundary crossing flags from the crossing of each boundary
+ *
+ * @param x0 Whether the -X boundary is crossed
+ * @param x1 Whether the +X boundary is crossed
+ * @param y0 Whether the -Y boundary is crossed
+ * @param y1 Whether the +Y boundary is crossed
+ * @param z0 Whether the -Z boundary is crossed
+ * @param z1 Whether the +Z boundary is crossed
+ * @return ParticleStatus Crossing flags
+ * @details
+ * The flags are composed arithmetically, without any branch.
+ */
+constexpr ParticleStatus CrossStatus(bool x0, bool x1, bool y0, bool y1,
+                                     bool z0, bool z1) {
+  return static_cast<ParticleStatus>(
+      (x0 << 2) | (x1 << 3) | (y0 << 4) | (y1 << 5) | (z0 << 6) | (z1 << 7));
+}
+
+/**
+ * @brief Neighbour offset of each value of the two crossing bits of an axis
+ *
+ * @details
+ * The value `3`, i.e. both boundaries of an axis crossed, is invalid and
+ * mapped to no offset.
+ */
+inline constexpr int8_t __LILIP_CROSS_OFFSET[4] = {0, -1, 1, 0};
+
+/**
+ * @brief Neighbour offset of a status along an axis
+ *
+ * @param status Particle status
+ * @param axis Axis index, 0 for X, 1 for Y, and 2 for Z
+ * @return int Neighbour offset, -1, 0, or +1
+ */
+constexpr int CrossOffset(ParticleStatus status, int axis) {
+  return __LILIP_CROSS_OFFSET[(static_cast<uint8_t>(status) >>
+                               (__LILIP_STATUS_CROSS_SHIFT + 2 * axis)) &
+                              3];
+}
+
+/**
+ * @brief Build the table from the crossing flags to the neighbour index
+ *
+ * @return std::array<int8_t, 64> Neighbour index of each crossing flag set
+ */
+constexpr std::array<int8_t, 64> MakeNeighbourTable() {
+  std::array<int8_t, 64> table = {};
+  for (int flags = 0; flags < 64; ++flags) {
+    const int dx = __LILIP_CROSS_OFFSET[flags & 3];
+    const int dy = __LILIP_CROSS_OFFSET[(flags >> 2) & 3];
+    const int dz = __LILIP_CROSS_OFFSET[(flags >> 4) & 3];
+    table[flags] = (dx + 1) + 3 * ((dy + 1) + 3 * (dz + 1));
+  }
+  return table;
+}
+
+/**
+ * @brief Neighbour index of each set of crossing flags
+ */
+inline constexpr std::array<int8_t, 64> __LILIP_CROSS_NEIGHBOUR =
+    MakeNeighbourTable();
+
+/**
+ * @brief Neighbour a particle is migrating to
+ *
+ * @param status Particle status
+ * @return int Neighbour index \f$ (d_x + 1) + 3 ((d_y + 1) + 3 (d_z + 1))
+ * \f$ in `[0, 27)`, where 13 is the local domain
+ */
+constexpr int NeighbourIndex(ParticleStatus status) {
+  return __LILIP_CROSS_NEIGHBOUR[static_cast<uint8_t>(status) >>
+                                 __LILIP_STATUS_CROSS_SHIFT];
+}
+
+/**
+ * @brief Number of values of the legacy status enumeration
+ */
+#define __LILIP_LEGACY_NSTATUS 55
+
+/**
+ * @brief Build the table from the legacy status enumeration to the flags
+ *
+ * @return std::array<uint8_t, __LILIP_LEGACY_NSTATUS> Flags of each legacy
+ * value
+ * @details
+ * The legacy values are `Out`, `In`, `Tracked`, then the 26 combinations of
+ * crossed boundaries: the single boundaries `X0 X1 Y0 Y1 Z0 Z1`, the pairs
+ * of the `XY`, `XZ`, and `YZ` axes, and the triples, each with the lower
+ * boundary first. The same 26 combinations follow for tracked particles.
+ */
+constexpr std::array<uint8_t, __LILIP_LEGACY_NSTATUS> MakeLegacyStatusTable() {
+  std::array<uint8_t, __LILIP_LEGACY_NSTATUS> table = {};
+  table[0] = static_cast<uint8_t>(ParticleStatus::Out);
+  table[1] = static_cast<uint8_t>(ParticleStatus::In);
+  table[2] = static_cast<uint8_t>(ParticleStatus::Tracked);
+
+  // Crossing bit of a side of an axis
+  auto bit = [](int axis, int side) {
+    return 1 << (__LILIP_STATUS_CROSS_SHIFT + 2 * axis + side);
+  };
+  int k = 3;
+  for (int a = 0; a < 3; ++a) {
+    for (int sa = 0; sa < 2; ++sa) {
+      table[k++] = bit(a, sa);
+    }
+  }
+  for (int a = 0; a < 3; ++a) {
+    for (int b = a + 1; b < 3; ++b) {
+      for (int sa = 0; sa < 2; ++sa) {
+        for (int sb = 0; sb < 2; ++sb) {
+          table[k++] = bit(a, sa) | bit(b, sb);
+        }
+      }
+    }
+  }
+  for (int sx = 0; sx < 2; ++sx) {
+    for (int sy = 0; sy < 2; ++sy) {
+      for (int sz = 0; sz < 2; ++sz) {
+        table[k++] = bit(0, sx) | bit(1, sy) | bit(2, sz);
+      }
+    }
+  }
+
+  // Tracked particles
+  for (int m = 0; m < 26; ++m) {
+    table[k++] =
+        table[3 + m] | static_cast<uint8_t>(ParticleStatus::Tracked);
+  }
+  return table;
+}
+
+/**
+ * @brief Flags of each value of the legacy status enumeration
+ */
+inline constexpr std::array<uint8_t, __LILIP_LEGACY_NSTATUS>
+    __LILIP_LEGACY_STATUS = MakeLegacyStatusTable();
+
+/**
+ * @brief Convert a value of the legacy status enumeration to the flags
+ *
+ * @param[in] value Legacy status value
+ * @param[out] status Particle status
+ * @return bool Whether the value is a valid legacy status
+ */
+constexpr bool LegacyStatus(unsigned value, ParticleStatus& status) {
+  if (value >= __LILIP_LEGACY_NSTATUS) {
+    return false;
+  }
+  status = static_cast<ParticleStatus>(__LILIP_LEGACY_STATUS[value]);
+  return true;
+}
+
+static_assert(NeighbourIndex(ParticleStatus::Tracked) == 13);
+static_assert(NeighbourIndex(ParticleStatus::X0 | ParticleStatus::Y0 |
+                             ParticleStatus::Z0) == 0);
+static_assert(NeighbourIndex(ParticleStatus::X1 | ParticleStatus::Y1 |
+                             ParticleStatus::Z1) == 26);
+static_assert(__LILIP_LEGACY_STATUS[28] ==
+              static_cast<uint8_t>(ParticleStatus::X1 | ParticleStatus::Y1 |
+                                   ParticleStatus::Z1));
+static_assert(__LILIP_LEGACY_STATUS[29] ==
+              static_cast<uint8_t>(ParticleStatus::Tracked |
+                                   ParticleStatus::X0));
+}  // namespace lili::particle
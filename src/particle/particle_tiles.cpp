@@ -0,0 +1,110 @@
+/**
+ * @file particle_tiles.cpp
+ * @brief Source file for the ParticleTiles class
+ */
+#include "particle_tiles.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace lili::particle {
+ParticleTiles::ParticleTiles()
+    : mesh_size_(),
+      tx_(1),
+      ty_(1),
+      tz_(1),
+      ntx_(0),
+      nty_(0),
+      ntz_(0),
+      npar_(0),
+      built_(false) {}
+
+ParticleTiles::ParticleTiles(const mesh::MeshSize& mesh_size, int tx, int ty,
+                             int tz, mesh::CellOrder order)
+    : mesh_size_(mesh_size),
+      tx_(std::clamp(tx, 1, mesh_size.nx)),
+      ty_(std::clamp(ty, 1, mesh_size.ny)),
+      tz_(std::clamp(tz, 1, mesh_size.nz)),
+      ntx_((mesh_size.nx + tx_ - 1) / tx_),
+      nty_((mesh_size.ny + ty_ - 1) / ty_),
+      ntz_((mesh_size.nz + tz_ - 1) / tz_),
+      npar_(0),
+      built_(false) {
+  // Traversal order of the tiles
+  tiles_ = mesh::CellOrderBlocks(order, ntx_, nty_, ntz_);
+  tile_rank_.resize(tiles_.size());
+  for (std::size_t r = 0; r < tiles_.size(); ++r) {
+    tile_rank_[tiles_[r]] = r;
+  }
+
+  // Traversal order of the cells inside a tile
+  std::vector<int> cells = mesh::CellOrderBlocks(order, tx_, ty_, tz_);
+  cell_rank_.resize(cells.size());
+  for (std::size_t r = 0; r < cells.size(); ++r) {
+    cell_rank_[cells[r]] = r;
+  }
+
+  offset_.assign(ntile() + 1, 0);
+}
+
+template <typename TX, typename TU>
+void ParticleTiles::Build(ParticlesT<TX, TU>& particles) {
+  const int npar = particles.npar();
+  const int ncell = tx_ * ty_ * tz_;
+  const bool cell = (particles.layout() == input::PPosLayout::Cell);
+
+  const double crx = mesh_size_.nx / mesh_size_.lx;
+  const double cry = mesh_size_.ny / mesh_size_.ly;
+  const double crz = mesh_size_.nz / mesh_size_.lz;
+
+  // Combined tile and in-tile cell rank of each particle
+  std::vector<uint64_t> key(npar);
+
+#pragma omp parallel for if (npar >= __LILIP_DEFAULT_OMPSIZE)
+  for (int i = 0; i < npar; ++i) {
+    int ix, iy, iz;
+    if (cell) {
+      ix = particles.ix(i);
+      iy = particles.iy(i);
+      iz = particles.iz(i);
+    } else {
+      ix = std::floor((particles.x(i) - mesh_size_.x0) * crx);
+      iy = std::floor((particles.y(i) - mesh_size_.y0) * cry);
+      iz = std::floor((particles.z(i) - mesh_size_.z0) * crz);
+    }
+    ix = std::clamp(ix, 0, mesh_size_.nx - 1);
+    iy = std::clamp(iy, 0, mesh_size_.ny - 1);
+    iz = std::clamp(iz, 0, mesh_size_.nz - 1);
+
+    const int itx = ix / tx_;
+    const int ity = iy / ty_;
+    const int itz = iz / tz_;
+    const int it = itx + ntx_ * (ity + nty_ * itz);
+    const int ic =
+        (ix - itx * tx_) + tx_ * ((iy - ity * ty_) + ty_ * (iz - itz * tz_));
+
+    key[i] = static_cast<uint64_t>(tile_rank_[it]) * ncell + cell_rank_[ic];
+  }
+
+  // Count the particles in each tile
+  std::fill(offset_.begin(), offset_.end(), 0);
+  for (int i = 0; i < npar; ++i) {
+    ++offset_[key[i] / ncell + 1];
+  }
+  for (int it = 0; it < ntile(); ++it) {
+    offset_[it + 1] += offset_[it];
+  }
+
+  // Sort the particles by tile
+  SortParticlesByKey(particles, key.data());
+
+  npar_ = npar;
+  built_ = true;
+}
+
+// Explicit instantiation for each supported precision
+template void ParticleTiles::Build(ParticlesT<double, double>&);
+template void ParticleTiles::Build(ParticlesT<double, float>&);
+template void ParticleTiles::Build(ParticlesT<float, float>&);
+}  // namespace lili::particle
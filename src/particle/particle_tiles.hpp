@@ -0,0 +1,111 @@
+/**
+ * @file particle_tiles.hpp
+ * @brief Header file for the ParticleTiles class
+ */
+#pragma once
+
+#include <vector>
+
+#include "mesh.hpp"
+#include "particle.hpp"
+#include "sfc.hpp"
+
+namespace lili::particle {
+/**
+ * @brief Class to partition the particles of a single species into tiles of
+ * the mesh
+ *
+ * @details
+ * The mesh is split into rectangular tiles of `tx` x `ty` x `tz` cells. The
+ * tiles wrap a flat Particles object: Build sorts the particles by tile, and
+ * by cell inside each tile, so that the particles of tile `it` are stored
+ * contiguously in `[begin(it), end(it))`. The Particles data layout, and thus
+ * SaveParticles, is unchanged.
+ *
+ * The tiles are independent units of work: a kernel running over one tile
+ * only touches the field stencil around that tile, which stays in the L1/L2
+ * cache, and different tiles can be processed by different threads. The
+ * tiles are traversed following the mesh::CellOrder given at construction.
+ *
+ * Moving particles between tiles is done by calling Build again. Until then,
+ * particles that have left their tile are still processed with the old tile,
+ * which only costs locality, not correctness.
+ */
+class ParticleTiles {
+ public:
+  // Constructor
+  ParticleTiles();
+
+  /**
+   * @brief Constructor for the tiles of a mesh
+   *
+   * @param mesh_size Mesh size of the domain
+   * @param tx Number of cells per tile in the X-axis
+   * @param ty Number of cells per tile in the Y-axis
+   * @param tz Number of cells per tile in the Z-axis
+   * @param order Traversal order of the tiles and of the cells in a tile
+   */
+  ParticleTiles(const mesh::MeshSize& mesh_size, int tx, int ty, int tz,
+                mesh::CellOrder order = mesh::CellOrder::RowMajor);
+
+  // Getters
+  /// @cond GETTERS
+  int ntile() const { return ntx_ * nty_ * ntz_; }
+  int npar() const { return npar_; }
+  int tx() const { return tx_; }
+  int ty() const { return ty_; }
+  int tz() const { return tz_; }
+  int begin(int it) const { return offset_[it]; }
+  int end(int it) const { return offset_[it + 1]; }
+  int tile(int it) const { return tiles_[it]; }
+  /// @endcond
+
+  /**
+   * @brief Check whether the tiles cover a given number of particles
+   *
+   * @param npar Number of particles
+   * @return bool Whether the tiles have been built for `npar` particles
+   * @details
+   * The tiles need to be rebuilt when particles are added or removed.
+   */
+  bool Covers(int npar) const { return built_ && npar == npar_; }
+
+  /**
+   * @brief Check whether two tilings share the same tiles
+   *
+   * @param other Other ParticleTiles object
+   * @return bool Whether the tiles and their traversal order are the same
+   * @details
+   * Tiles of different species that match can be processed together, tile
+   * by tile, so that the field stencil of a tile is loaded once.
+   */
+  bool Matches(const ParticleTiles& other) const {
+    return tx_ == other.tx_ && ty_ == other.ty_ && tz_ == other.tz_ &&
+           tiles_ == other.tiles_;
+  }
+
+  /**
+   * @brief Sort the particles by tile and compute the tile offsets
+   *
+   * @param particles Particles object
+   * @details
+   * The particles are sorted with SortParticlesByKey on the combined tile and
+   * in-tile cell rank. Particles outside of the domain are assigned to the
+   * closest cell.
+   */
+  template <typename TX, typename TU>
+  void Build(ParticlesT<TX, TU>& particles);
+
+ private:
+  mesh::MeshSize mesh_size_;  ///< Mesh size of the domain
+  int tx_, ty_, tz_;          ///< Number of cells per tile
+  int ntx_, nty_, ntz_;       ///< Number of tiles per axis
+  int npar_;                  ///< Number of particles in the last Build
+  bool built_;                ///< Whether Build has been called
+
+  std::vector<int> tiles_;      ///< Row-major tile index in traversal order
+  std::vector<int> tile_rank_;  ///< Traversal rank of each row-major tile
+  std::vector<int> cell_rank_;  ///< Traversal rank of each cell in a tile
+  std::vector<int> offset_;     ///< Start of each tile in the particles
+};
+}  // namespace lili::particle
@@ -8,24 +8,28 @@
 #include <iomanip>
 #include <iostream>
 #include <sstream>
+#include <vector>
 
 #include "fields.hpp"
 #include "hdf5.h"
 #include "mesh.hpp"
+#include "output_hdf5.hpp"
+#include "particle_hdf5.hpp"
 
 namespace lili::particle {
-void TrackParticles::InitializeTrackParticles() {
+template <typename TX, typename TU>
+void TrackParticlesT<TX, TU>::InitializeTrackParticles() {
   // Initialize the particles
-  track_particles = Particles(n_track_);
+  track_particles = ParticlesT<TX, TU>(n_track_);
 
   // Allocate memory for the tracked particles
   idtrack_ = new ulong[n_track_ * dtrack_save_]();
-  xtrack_ = new double[n_track_ * dtrack_save_]();
-  ytrack_ = new double[n_track_ * dtrack_save_]();
-  ztrack_ = new double[n_track_ * dtrack_save_]();
-  utrack_ = new double[n_track_ * dtrack_save_]();
-  vtrack_ = new double[n_track_ * dtrack_save_]();
-  wtrack_ = new double[n_track_ * dtrack_save_]();
+  xtrack_ = new TX[n_track_ * dtrack_save_]();
+  ytrack_ = new TX[n_track_ * dtrack_save_]();
+  ztrack_ = new TX[n_track_ * dtrack_save_]();
+  utrack_ = new TU[n_track_ * dtrack_save_]();
+  vtrack_ = new TU[n_track_ * dtrack_save_]();
+  wtrack_ = new TU[n_track_ * dtrack_save_]();
   extrack_ = new double[n_track_ * dtrack_save_]();
   eytrack_ = new double[n_track_ * dtrack_save_]();
   eztrack_ = new double[n_track_ * dtrack_save_]();
@@ -34,8 +38,9 @@ void TrackParticles::InitializeTrackParticles() {
   bztrack_ = new double[n_track_ * dtrack_save_]();
 }
 
-void TrackParticles::SaveTrackedParticles(Particles& particles) {
-  // Copy tracked particles to the current cache
+template <typename TX, typename TU>
+void TrackParticlesT<TX, TU>::SelectTrackedParticles(
+    ParticlesT<TX, TU>& particles) {
   SelectParticles(particles, track_particles, ParticleStatus::Tracked);
   if (track_particles.npar() != n_track_) {
     std::cerr << "Error: number of tracked particles is not correct"
@@ -43,12 +48,26 @@ void TrackParticles::SaveTrackedParticles(Particles& particles) {
     exit(1);
   }
 
+  // Keep the tracked particles in a fixed order
+  std::vector<uint64_t> key(n_track_);
+  for (int i_track = 0; i_track < n_track_; ++i_track) {
+    key[i_track] = track_particles.id(i_track);
+  }
+  SortParticlesByKey(track_particles, key.data());
+}
+
+template <typename TX, typename TU>
+void TrackParticlesT<TX, TU>::SaveTrackedParticles(
+    ParticlesT<TX, TU>& particles) {
+  // Copy tracked particles to the current cache
+  SelectTrackedParticles(particles);
+
   // Move the data to the dump cache
   for (int i_track = 0; i_track < n_track_; ++i_track) {
     idtrack_[i_track_ * n_track_ + i_track] = track_particles.id(i_track);
-    xtrack_[i_track_ * n_track_ + i_track] = track_particles.x(i_track);
-    ytrack_[i_track_ * n_track_ + i_track] = track_particles.y(i_track);
-    ztrack_[i_track_ * n_track_ + i_track] = track_particles.z(i_track);
+    xtrack_[i_track_ * n_track_ + i_track] = track_particles.PhysicalX(i_track);
+    ytrack_[i_track_ * n_track_ + i_track] = track_particles.PhysicalY(i_track);
+    ztrack_[i_track_ * n_track_ + i_track] = track_particles.PhysicalZ(i_track);
     utrack_[i_track_ * n_track_ + i_track] = track_particles.u(i_track);
     vtrack_[i_track_ * n_track_ + i_track] = track_particles.v(i_track);
     wtrack_[i_track_ * n_track_ + i_track] = track_particles.w(i_track);
@@ -63,51 +82,40 @@ void TrackParticles::SaveTrackedParticles(Particles& particles) {
   }
 }
 
-void TrackParticles::SaveTrackedParticles(Particles& particles,
-                                          mesh::Fields& fields) {
+template <typename TX, typename TU>
+void TrackParticlesT<TX, TU>::SaveTrackedParticles(
+    ParticlesT<TX, TU>& particles, mesh::Fields& fields) {
   // Copy tracked particles to the current cache
-  SelectParticles(particles, track_particles, ParticleStatus::Tracked);
-  if (track_particles.npar() != n_track_) {
-    std::cout << "Error: number of tracked particles is not correct"
-              << std::endl;
-    exit(1);
-  }
+  SelectTrackedParticles(particles);
 
   // Move the data to the dump cache
+  const int offset = i_track_ * n_track_;
+  std::vector<double> xloc(n_track_), yloc(n_track_), zloc(n_track_);
   for (int i_track = 0; i_track < n_track_; ++i_track) {
-    idtrack_[i_track_ * n_track_ + i_track] = track_particles.id(i_track);
+    idtrack_[offset + i_track] = track_particles.id(i_track);
 
-    double xloc = track_particles.x(i_track);
-    double yloc = track_particles.y(i_track);
-    double zloc = track_particles.z(i_track);
+    const double px = track_particles.PhysicalX(i_track);
+    const double py = track_particles.PhysicalY(i_track);
+    const double pz = track_particles.PhysicalZ(i_track);
 
-    xtrack_[i_track_ * n_track_ + i_track] = xloc;
-    ytrack_[i_track_ * n_track_ + i_track] = yloc;
-    ztrack_[i_track_ * n_track_ + i_track] = zloc;
-    utrack_[i_track_ * n_track_ + i_track] = track_particles.u(i_track);
-    vtrack_[i_track_ * n_track_ + i_track] = track_particles.v(i_track);
-    wtrack_[i_track_ * n_track_ + i_track] = track_particles.w(i_track);
+    xtrack_[offset + i_track] = px;
+    ytrack_[offset + i_track] = py;
+    ztrack_[offset + i_track] = pz;
+    utrack_[offset + i_track] = track_particles.u(i_track);
+    vtrack_[offset + i_track] = track_particles.v(i_track);
+    wtrack_[offset + i_track] = track_particles.w(i_track);
 
     // Move the particle location to the mesh coordinate
-    xloc = (xloc - fields.size.x0) / fields.size.lx * fields.size.nx;
-    yloc = (yloc - fields.size.y0) / fields.size.ly * fields.size.ny;
-    zloc = (zloc - fields.size.z0) / fields.size.lz * fields.size.nz;
-
-    // Store the fields
-    extrack_[i_track_ * n_track_ + i_track] =
-        fields.ex.Interpolation(xloc, yloc, zloc);
-    eytrack_[i_track_ * n_track_ + i_track] =
-        fields.ey.Interpolation(xloc, yloc, zloc);
-    eztrack_[i_track_ * n_track_ + i_track] =
-        fields.ez.Interpolation(xloc, yloc, zloc);
-    bxtrack_[i_track_ * n_track_ + i_track] =
-        fields.bx.Interpolation(xloc, yloc, zloc);
-    bytrack_[i_track_ * n_track_ + i_track] =
-        fields.by.Interpolation(xloc, yloc, zloc);
-    bztrack_[i_track_ * n_track_ + i_track] =
-        fields.bz.Interpolation(xloc, yloc, zloc);
+    xloc[i_track] = (px - fields.size.x0) / fields.size.lx * fields.size.nx;
+    yloc[i_track] = (py - fields.size.y0) / fields.size.ly * fields.size.ny;
+    zloc[i_track] = (pz - fields.size.z0) / fields.size.lz * fields.size.nz;
   }
 
+  // Store the fields
+  fields.GatherEB(xloc.data(), yloc.data(), zloc.data(), n_track_,
+                  extrack_ + offset, eytrack_ + offset, eztrack_ + offset,
+                  bxtrack_ + offset, bytrack_ + offset, bztrack_ + offset);
+
   // Increment the tracking index
   ++i_track_;
 
@@ -117,12 +125,14 @@ void TrackParticles::SaveTrackedParticles(Particles& particles,
   }
 }
 
-void TrackParticles::DumpTrackedParticles() {
+template <typename TX, typename TU>
+void TrackParticlesT<TX, TU>::DumpTrackedParticles() {
   // Set filename and create file
   std::stringstream ss;
   ss << std::setw(5) << std::setfill('0') << i_dump_;
   std::string filename = prefix_ + "_" + ss.str() + ".h5";
   std::cout << "Dumping tracked particles to " << filename << std::endl;
+  std::lock_guard<std::mutex> lock(lili::output::h5_mutex);
   hid_t file_id =
       H5Fcreate(filename.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
 
@@ -134,86 +144,93 @@ void TrackParticles::DumpTrackedParticles() {
   hsize_t dims[2] = {static_cast<hsize_t>(i_track_),
                      static_cast<hsize_t>(n_track_)};
   hid_t dataspace_id = H5Screate_simple(2, dims, NULL);
+  hid_t dcpl_id = lili::output::H5DatasetCreatePlist(2, dims);
 
   // Write the particle IDs
   hid_t dataset_id = H5Dcreate(file_id, "id", H5T_NATIVE_ULONG, dataspace_id,
-                               H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+                               H5P_DEFAULT, dcpl_id, H5P_DEFAULT);
   H5Dwrite(dataset_id, H5T_NATIVE_ULONG, H5S_ALL, H5S_ALL, H5P_DEFAULT,
            idtrack_);
   H5Dclose(dataset_id);
 
   // Write the particle coordinates
-  dataset_id = H5Dcreate(file_id, "x", H5T_NATIVE_DOUBLE, dataspace_id,
-                         H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-  H5Dwrite(dataset_id, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT,
+  dataset_id = H5Dcreate(file_id, "x", H5NativeType<TX>(), dataspace_id,
+                         H5P_DEFAULT, dcpl_id, H5P_DEFAULT);
+  H5Dwrite(dataset_id, H5NativeType<TX>(), H5S_ALL, H5S_ALL, H5P_DEFAULT,
            xtrack_);
   H5Dclose(dataset_id);
-  dataset_id = H5Dcreate(file_id, "y", H5T_NATIVE_DOUBLE, dataspace_id,
-                         H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-  H5Dwrite(dataset_id, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT,
+  dataset_id = H5Dcreate(file_id, "y", H5NativeType<TX>(), dataspace_id,
+                         H5P_DEFAULT, dcpl_id, H5P_DEFAULT);
+  H5Dwrite(dataset_id, H5NativeType<TX>(), H5S_ALL, H5S_ALL, H5P_DEFAULT,
            ytrack_);
   H5Dclose(dataset_id);
-  dataset_id = H5Dcreate(file_id, "z", H5T_NATIVE_DOUBLE, dataspace_id,
-                         H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-  H5Dwrite(dataset_id, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT,
+  dataset_id = H5Dcreate(file_id, "z", H5NativeType<TX>(), dataspace_id,
+                         H5P_DEFAULT, dcpl_id, H5P_DEFAULT);
+  H5Dwrite(dataset_id, H5NativeType<TX>(), H5S_ALL, H5S_ALL, H5P_DEFAULT,
            ztrack_);
   H5Dclose(dataset_id);
 
   // Write the particle velocities
-  dataset_id = H5Dcreate(file_id, "u", H5T_NATIVE_DOUBLE, dataspace_id,
-                         H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-  H5Dwrite(dataset_id, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT,
+  dataset_id = H5Dcreate(file_id, "u", H5NativeType<TU>(), dataspace_id,
+                         H5P_DEFAULT, dcpl_id, H5P_DEFAULT);
+  H5Dwrite(dataset_id, H5NativeType<TU>(), H5S_ALL, H5S_ALL, H5P_DEFAULT,
            utrack_);
   H5Dclose(dataset_id);
-  dataset_id = H5Dcreate(file_id, "v", H5T_NATIVE_DOUBLE, dataspace_id,
-                         H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-  H5Dwrite(dataset_id, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT,
+  dataset_id = H5Dcreate(file_id, "v", H5NativeType<TU>(), dataspace_id,
+                         H5P_DEFAULT, dcpl_id, H5P_DEFAULT);
+  H5Dwrite(dataset_id, H5NativeType<TU>(), H5S_ALL, H5S_ALL, H5P_DEFAULT,
            vtrack_);
   H5Dclose(dataset_id);
-  dataset_id = H5Dcreate(file_id, "w", H5T_NATIVE_DOUBLE, dataspace_id,
-                         H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
-  H5Dwrite(dataset_id, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT,
+  dataset_id = H5Dcreate(file_id, "w", H5NativeType<TU>(), dataspace_id,
+                         H5P_DEFAULT, dcpl_id, H5P_DEFAULT);
+  H5Dwrite(dataset_id, H5NativeType<TU>(), H5S_ALL, H5S_ALL, H5P_DEFAULT,
            wtrack_);
   H5Dclose(dataset_id);
 
   // Write the particle local fields
   dataset_id = H5Dcreate(file_id, "ex", H5T_NATIVE_DOUBLE, dataspace_id,
-                         H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+                         H5P_DEFAULT, dcpl_id, H5P_DEFAULT);
   H5Dwrite(dataset_id, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT,
            extrack_);
   H5Dclose(dataset_id);
   dataset_id = H5Dcreate(file_id, "ey", H5T_NATIVE_DOUBLE, dataspace_id,
-                         H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+                         H5P_DEFAULT, dcpl_id, H5P_DEFAULT);
   H5Dwrite(dataset_id, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT,
            eytrack_);
   H5Dclose(dataset_id);
   dataset_id = H5Dcreate(file_id, "ez", H5T_NATIVE_DOUBLE, dataspace_id,
-                         H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+                         H5P_DEFAULT, dcpl_id, H5P_DEFAULT);
   H5Dwrite(dataset_id, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT,
            eztrack_);
   H5Dclose(dataset_id);
   dataset_id = H5Dcreate(file_id, "bx", H5T_NATIVE_DOUBLE, dataspace_id,
-                         H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+                         H5P_DEFAULT, dcpl_id, H5P_DEFAULT);
   H5Dwrite(dataset_id, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT,
            bxtrack_);
   H5Dclose(dataset_id);
   dataset_id = H5Dcreate(file_id, "by", H5T_NATIVE_DOUBLE, dataspace_id,
-                         H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+                         H5P_DEFAULT, dcpl_id, H5P_DEFAULT);
   H5Dwrite(dataset_id, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT,
            bytrack_);
   H5Dclose(dataset_id);
   dataset_id = H5Dcreate(file_id, "bz", H5T_NATIVE_DOUBLE, dataspace_id,
-                         H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+                         H5P_DEFAULT, dcpl_id, H5P_DEFAULT);
   H5Dwrite(dataset_id, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT,
            bztrack_);
   H5Dclose(dataset_id);
 
-  // Close dataspace and file
+  // Close dataspace, property list and file
   H5Sclose(dataspace_id);
+  lili::output::H5ClosePlist(dcpl_id);
   H5Fclose(file_id);
 
   // Add the dump index and clear the tracking index
   ++i_dump_;
   i_track_ = 0;
 }
+
+// Explicit instantiation for each supported precision
+template class TrackParticlesT<double, double>;
+template class TrackParticlesT<double, float>;
+template class TrackParticlesT<float, float>;
 }  // namespace lili::particle
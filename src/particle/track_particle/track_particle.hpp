@@ -12,14 +12,21 @@
 namespace lili::particle {
 /**
  * @brief TrackParticles class
+ *
+ * @tparam TX Floating point type of the positions
+ * @tparam TU Floating point type of the velocities
+ * @details
+ * The positions and velocities are buffered and dumped with the same
+ * precision as the particles, the fields are always stored as `double`.
  */
-class TrackParticles {
+template <typename TX = __LILIP_REAL_X, typename TU = __LILIP_REAL_U>
+class TrackParticlesT {
  public:
   // Constructor
   /**
    * @brief Default constructor for TrackParticles
    */
-  TrackParticles()
+  TrackParticlesT()
       : n_track_(0), dtrack_save_(0), i_track_(0), i_dump_(0), prefix_("tp_") {
     InitializeTrackParticles();
   }
@@ -31,7 +38,7 @@ class TrackParticles {
    * @param n_track Number of tracked particles in the buffer
    * @param dtrack_save Number of time steps between tracking output
    */
-  TrackParticles(int n_track, int dtrack_save)
+  TrackParticlesT(int n_track, int dtrack_save)
       : n_track_(n_track),
         dtrack_save_(dtrack_save),
         i_track_(0),
@@ -41,7 +48,7 @@ class TrackParticles {
   }
 
   // Copy constructor
-  TrackParticles(const TrackParticles& other)
+  TrackParticlesT(const TrackParticlesT& other)
       : n_track_(other.n_track_),
         dtrack_save_(other.dtrack_save_),
         i_track_(other.i_track_),
@@ -71,12 +78,12 @@ class TrackParticles {
   }
 
   // Move constructor
-  TrackParticles(TrackParticles&& other) noexcept : TrackParticles() {
+  TrackParticlesT(TrackParticlesT&& other) noexcept : TrackParticlesT() {
     swap(*this, other);
   };
 
   // Destructor
-  ~TrackParticles() {
+  ~TrackParticlesT() {
     delete[] idtrack_;
     delete[] xtrack_;
     delete[] ytrack_;
@@ -93,7 +100,7 @@ class TrackParticles {
   };
 
   // Swap data
-  friend void swap(TrackParticles& first, TrackParticles& second) noexcept {
+  friend void swap(TrackParticlesT& first, TrackParticlesT& second) noexcept {
     using std::swap;
     swap(first.n_track_, second.n_track_);
     swap(first.dtrack_save_, second.dtrack_save_);
@@ -117,7 +124,7 @@ class TrackParticles {
   }
 
   // Operators
-  TrackParticles& operator=(TrackParticles other) {
+  TrackParticlesT& operator=(TrackParticlesT other) {
     swap(*this, other);
     return *this;
   }
@@ -132,7 +139,7 @@ class TrackParticles {
    *
    * @param particles Particles object
    */
-  void SaveTrackedParticles(Particles& particles);
+  void SaveTrackedParticles(ParticlesT<TX, TU>& particles);
 
   /**
    * @brief Save tracked particles with fields information
@@ -140,7 +147,8 @@ class TrackParticles {
    * @param particles Particles object
    * @param fields Fields object
    */
-  void SaveTrackedParticles(Particles& particles, mesh::Fields& fields);
+  void SaveTrackedParticles(ParticlesT<TX, TU>& particles,
+                            mesh::Fields& fields);
 
   /**
    * @brief Dump tracked particles to an HDF5 file
@@ -164,9 +172,20 @@ class TrackParticles {
   /// @endcond
 
   // Public data members
-  Particles track_particles;
+  ParticlesT<TX, TU> track_particles;
 
  private:
+  /**
+   * @brief Copy the tracked particles to track_particles, ordered by ID
+   *
+   * @param particles Particles object
+   * @details
+   * The order of the particles changes when they are sorted, so the tracked
+   * particles are ordered by ID to keep each particle in the same column of
+   * the tracking output.
+   */
+  void SelectTrackedParticles(ParticlesT<TX, TU>& particles);
+
   int n_track_;         ///< Number of tracked particles in the buffer
   int dl_track_;        ///< Number of loop iteration between tracking output
   int dtrack_save_;     ///< Number of tracking output between dumps
@@ -174,9 +193,14 @@ class TrackParticles {
   int i_dump_;          ///< Current index of the current dump
   std::string prefix_;  ///< Prefix for the output file
   ulong* idtrack_;      ///< Tracked particle ID
-  double *xtrack_, *ytrack_, *ztrack_;     ///< Tracked particle location
-  double *utrack_, *vtrack_, *wtrack_;     ///< Tracked particle velocity
+  TX *xtrack_, *ytrack_, *ztrack_;         ///< Tracked particle location
+  TU *utrack_, *vtrack_, *wtrack_;         ///< Tracked particle velocity
   double *extrack_, *eytrack_, *eztrack_;  ///< Tracked particle electric field
   double *bxtrack_, *bytrack_, *bztrack_;  ///< Tracked particle magnetic field
 };
+
+/**
+ * @brief TrackParticles type used by the simulation
+ */
+using TrackParticles = TrackParticlesT<>;
 }  // namespace lili::particle
@@ -187,9 +187,26 @@ void TaskInitParticles::Initialize() {
   // Get the number of particle species
   n_kind_ = input_particles_.size();
 
-  // Initialize particles and tracked particles
-  std::vector<particle::Particles> particles(n_kind_);
-  std::vector<particle::TrackParticles> track_particles(n_kind_);
+  // Create the particles and tracked particles vectors directly in the
+  // sim_vars, the species are then constructed in place without any copy
+  sim_vars[SimVarType::ParticlesVector] =
+      std::make_unique<std::vector<particle::Particles>>();
+  particles_ptr_ = std::get<std::unique_ptr<std::vector<particle::Particles>>>(
+                       sim_vars[SimVarType::ParticlesVector])
+                       .get();
+
+  sim_vars[SimVarType::TrackParticlesVector] =
+      std::make_unique<std::vector<particle::TrackParticles>>();
+  track_particles_ptr_ =
+      std::get<std::unique_ptr<std::vector<particle::TrackParticles>>>(
+          sim_vars[SimVarType::TrackParticlesVector])
+          .get();
+
+  std::vector<particle::Particles>& particles = *particles_ptr_;
+  std::vector<particle::TrackParticles>& track_particles =
+      *track_particles_ptr_;
+  particles.reserve(n_kind_);
+  track_particles.reserve(n_kind_);
 
   // Initialize the helper vectors
   n_track_.resize(n_kind_);
@@ -198,7 +215,7 @@ void TaskInitParticles::Initialize() {
   // Loop through all species
   for (int i_kind = 0; i_kind < n_kind_; ++i_kind) {
     // Initialize particles
-    particles[i_kind] = particle::Particles(input_particles_[i_kind]);
+    particles.emplace_back(input_particles_[i_kind]);
 
     // Distribute particle IDs
     particle::DistributeID(particles[i_kind],
@@ -246,8 +263,8 @@ void TaskInitParticles::Initialize() {
     dl_track_[i_kind] = input_particles_[i_kind].dl_track;
 
     // Initialize the helper TrackParticles object
-    track_particles[i_kind] =
-        particle::TrackParticles(n_track, input_particles_[i_kind].dtrack_save);
+    track_particles.emplace_back(n_track,
+                                 input_particles_[i_kind].dtrack_save);
 
     // Set the file prefix for the tracked particles
     track_particles[i_kind].SetPrefix(
@@ -262,25 +279,12 @@ void TaskInitParticles::Initialize() {
     for (int i = 0; i < n_track; ++i) {
       particles[i_kind].status(i) = particle::ParticleStatus::Tracked;
     }
-  }
 
-  // Assign the particles vector to the sim_vars
-  sim_vars[SimVarType::ParticlesVector] =
-      std::make_unique<std::vector<particle::Particles>>(particles);
-
-  // Store the reference in this object
-  particles_ptr_ = std::get<std::unique_ptr<std::vector<particle::Particles>>>(
-                       sim_vars[SimVarType::ParticlesVector])
-                       .get();
-
-  // Assign the track particles vector to the sim_vars
-  sim_vars[SimVarType::TrackParticlesVector] =
-      std::make_unique<std::vector<particle::TrackParticles>>(track_particles);
-  // Store the reference in this object
-  track_particles_ptr_ =
-      std::get<std::unique_ptr<std::vector<particle::TrackParticles>>>(
-          sim_vars[SimVarType::TrackParticlesVector])
-          .get();
+    // Convert the positions to the cell index and offset if needed
+    if (input_particles_[i_kind].pos_layout == input::PPosLayout::Cell) {
+      particles[i_kind].SetLayout(input::PPosLayout::Cell, mesh_size_);
+    }
+  }
 
   // Call the base class Initialize
   Task::Initialize();
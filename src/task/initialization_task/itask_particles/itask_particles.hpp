@@ -185,12 +185,16 @@ class TaskInitParticles : public Task {
 
     // Initialize the input particles
     input_particles_ = {};
+    mesh_size_ = {};
   }
   TaskInitParticles(const input::Input input) : Task(TaskType::InitParticles) {
     set_name("InitParticles");
 
     // Copy the input.particles()
     input_particles_ = input.particles();
+
+    // Copy the mesh size for the cell position layout
+    mesh_size_ = input.mesh();
   }
 
   /**
@@ -219,6 +223,7 @@ class TaskInitParticles : public Task {
  private:
   int n_kind_;  ///< Number of particle species
   std::vector<input::InputParticles> input_particles_;  ///< Input particles
+  mesh::MeshSize mesh_size_;  ///< Mesh size for the cell position layout
 
   /**
    * @brief Pointer to the simulation Particles vector
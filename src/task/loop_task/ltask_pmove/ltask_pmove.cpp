@@ -4,7 +4,9 @@
  */
 #include "ltask_pmove.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <numeric>
 
 #include "parameter.hpp"
 
@@ -14,14 +16,28 @@ namespace lili::particle {
  * @param[in] input
  * Input object
  */
-void ParticleMover::InitializeMover(const input::InputLoop& input) {
+void ParticleMover::InitializeMover(const input::InputLoop& input,
+                                    BoundaryPolicy boundary,
+                                    mesh::ShapeOrder shape) {
   // Set the particle mover type
   type_ = ParticleMoverType::Boris2D;
+  boundary_ = boundary;
+  shape_ = shape;
 
   // Set the Mover function pointer
   switch (type_) {
     case ParticleMoverType::Boris2D:
-      Move_ = &ParticleMover::MoveBoris2D;
+      switch (boundary_) {
+        case BoundaryPolicy::Label:
+          SetMoveBoris2D<BoundaryPolicy::Label>();
+          break;
+        case BoundaryPolicy::Absorb:
+          SetMoveBoris2D<BoundaryPolicy::Absorb>();
+          break;
+        default:
+          SetMoveBoris2D<BoundaryPolicy::Periodic>();
+          break;
+      }
       break;
 
     default:
@@ -33,6 +49,160 @@ void ParticleMover::InitializeMover(const input::InputLoop& input) {
   dt_ = input.dt;
 }
 
+void ParticleMover::InitializeFields(mesh::Fields& fields, bool test_particle,
+                                     bool interleave) const {
+  // Check the ghost cells of the shape function
+  if (!FitsGhost(fields.size)) {
+    lili::lerr << "Particle shape needs " << mesh::ShapeGhost(shape_)
+               << " ghost cells" << std::endl;
+    lili::output::LiliExit(2);
+  }
+
+  // The interleaved cache is built once, so the fields must be static
+  if (interleave) {
+    if (!test_particle) {
+      lili::lerr << "Interleaved fields need a test particle input"
+                 << std::endl;
+      lili::output::LiliExit(2);
+    }
+    fields.UpdateCache();
+  }
+}
+
+/**
+ * @brief Set the Boris 2D mover for the shape function of the mover
+ *
+ * @tparam BP Boundary policy
+ */
+template <BoundaryPolicy BP>
+void ParticleMover::SetMoveBoris2D() {
+  switch (shape_) {
+    case mesh::ShapeOrder::NGP:
+      Move_ = &ParticleMover::MoveBoris2D<BP, 0>;
+      break;
+    case mesh::ShapeOrder::TSC:
+      Move_ = &ParticleMover::MoveBoris2D<BP, 2>;
+      break;
+    case mesh::ShapeOrder::PQS:
+      Move_ = &ParticleMover::MoveBoris2D<BP, 3>;
+      break;
+    default:
+      Move_ = &ParticleMover::MoveBoris2D<BP, 1>;
+      break;
+  }
+}
+
+int ParticleMover::Move(Particles& particles, const mesh::Fields& fields,
+                        const ParticleTiles& tiles) {
+  const int ntile = tiles.ntile();
+  int ncross = 0;
+
+#pragma omp parallel for schedule(dynamic, 1) reduction(+ : ncross)
+  for (int it = 0; it < ntile; ++it) {
+    ncross += (this->*Move_)(particles, fields, tiles.begin(it), tiles.end(it),
+                             1);
+  }
+
+  return ncross;
+}
+
+int ParticleMover::Move(Particles& particles, const mesh::Fields& fields,
+                        int n_step) {
+  const int npar = particles.npar();
+  int ncross = 0;
+
+#pragma omp parallel for if (npar >= __LILIP_DEFAULT_OMPSIZE) \
+    reduction(+ : ncross)
+  for (int ib = 0; ib < npar; ib += __LILIP_DEFAULT_OMPSIZE) {
+    const int hi = std::min(ib + __LILIP_DEFAULT_OMPSIZE, npar);
+    ncross += (this->*Move_)(particles, fields, ib, hi, n_step);
+  }
+
+  return ncross;
+}
+
+std::vector<int> ParticleMover::Move(std::vector<Particles>& particles,
+                                     const mesh::Fields& fields,
+                                     const std::vector<ParticleTiles>& tiles) {
+  const int nspecies = particles.size();
+  const int ntile = tiles.empty() ? 0 : tiles[0].ntile();
+  std::vector<int> ncross(nspecies, 0);
+
+#pragma omp parallel for schedule(dynamic, 1)
+  for (int it = 0; it < ntile; ++it) {
+    for (int is = 0; is < nspecies; ++is) {
+      const int n = (this->*Move_)(particles[is], fields, tiles[is].begin(it),
+                                   tiles[is].end(it), 1);
+      if (n > 0) {
+#pragma omp atomic
+        ncross[is] += n;
+      }
+    }
+  }
+
+  return ncross;
+}
+
+namespace {
+/**
+ * @brief Apply the boundary policy to one axis of a particle position
+ *
+ * @tparam BP Boundary policy
+ * @param[in,out] r Position, or cell index, along the axis
+ * @param[in] lo Lower bound of the domain
+ * @param[in] hi Upper bound of the domain
+ * @param[in] l Period of the domain
+ * @return int Crossing bits of the axis, 1 for the lower and 2 for the upper
+ * boundary, following the ParticleStatus flags
+ * @details
+ * The position is wrapped periodically for all of the policies except
+ * BoundaryPolicy::Absorb.
+ */
+template <BoundaryPolicy BP, typename T, typename B>
+inline int BoundaryAxis(T& r, B lo, B hi, B l) {
+  int cross = 0;
+  if (r < lo) {
+    cross = 1;
+    if constexpr (BP != BoundaryPolicy::Absorb) {
+      r += l;
+    }
+  } else if (r > hi) {
+    cross = 2;
+    if constexpr (BP != BoundaryPolicy::Absorb) {
+      r -= l;
+    }
+  }
+  return cross;
+}
+
+/**
+ * @brief Update the particle status from the crossing bits
+ *
+ * @tparam BP Boundary policy
+ * @param[in,out] status Particle status
+ * @param[in] cx Crossing bits of the X-axis
+ * @param[in] cy Crossing bits of the Y-axis
+ * @return int Whether the particle has crossed a boundary
+ */
+template <BoundaryPolicy BP>
+inline int BoundaryStatus(ParticleStatus& status, int cx, int cy) {
+  if constexpr (BP == BoundaryPolicy::Periodic) {
+    (void)status;
+    return 0;
+  } else {
+    const int cross = (cx | (cy << 2)) << __LILIP_STATUS_CROSS_SHIFT;
+    status = (status & ~ParticleStatus(__LILIP_STATUS_CROSS_MASK)) |
+             ParticleStatus(cross);
+    if constexpr (BP == BoundaryPolicy::Absorb) {
+      if (cross != 0) {
+        status |= ParticleStatus::Out;
+      }
+    }
+    return cross != 0;
+  }
+}
+}  // namespace
+
 /**
  * @brief Move particles using the Boris particle mover
  *
@@ -40,23 +210,58 @@ void ParticleMover::InitializeMover(const input::InputLoop& input) {
  * Particles object
  * @param[in] fields
  * Fields object
+ * @param[in] lo
+ * First particle index to move
+ * @param[in] hi
+ * Last particle index (exclusive) to move
+ * @param[in] n_step
+ * Number of time steps to move each particle
+ * @return int
+ * Number of boundary crossings of the X or Y boundaries
+ * @details
+ * The boundary policy `BP` is applied to the X and Y axes in the same loop as
+ * the push. The Z-axis is not resolved in 2D and is always wrapped
+ * periodically.
+ *
+ * The particles are moved in blocks of `__LILIP_GATHER_BLOCK`: the fields of
+ * the whole block are gathered with mesh::Fields::GatherEB, with the shape
+ * function of order `Order`, then the block is pushed. Each block is moved
+ * the `n_step` steps before the next one, while it stays in cache. This is
+ * only valid for static fields. A particle absorbed by the
+ * BoundaryPolicy::Absorb policy stops at the step it leaves the domain.
  */
-void ParticleMover::MoveBoris2D(Particles& particles,
-                                const mesh::Fields& fields) {
+template <BoundaryPolicy BP, int Order>
+int ParticleMover::MoveBoris2D(Particles& particles, const mesh::Fields& fields,
+                               int lo, int hi, int n_step) {
+  // Particles stored with the cell index and offset
+  if (particles.layout() == input::PPosLayout::Cell) {
+    return MoveBoris2DCell<BP, Order>(particles, fields, lo, hi, n_step);
+  }
+
   // Initialize variables
-  const int npar = particles.npar();
   const double qmhdt = particles.q() * dt_ / (2.0 * particles.m());
 
   // Get the particle information
-  double* __restrict__ x = particles.x();
-  double* __restrict__ y = particles.y();
-  double* __restrict__ z = particles.z();
+  Particles::RealX* __restrict__ x = particles.x();
+  Particles::RealX* __restrict__ y = particles.y();
+  Particles::RealX* __restrict__ z = particles.z();
+
+  Particles::RealU* __restrict__ u = particles.u();
+  Particles::RealU* __restrict__ v = particles.v();
+  Particles::RealU* __restrict__ w = particles.w();
 
-  double* __restrict__ u = particles.u();
-  double* __restrict__ v = particles.v();
-  double* __restrict__ w = particles.w();
+  ParticleStatus* __restrict__ status = particles.status();
+
+  // Gathered fields of a block
+  alignas(__LILI_ALIGNMENT) double rx[__LILIP_GATHER_BLOCK];
+  alignas(__LILI_ALIGNMENT) double ry[__LILIP_GATHER_BLOCK];
+  alignas(__LILI_ALIGNMENT) double gex[__LILIP_GATHER_BLOCK];
+  alignas(__LILI_ALIGNMENT) double gey[__LILIP_GATHER_BLOCK];
+  alignas(__LILI_ALIGNMENT) double gez[__LILIP_GATHER_BLOCK];
+  alignas(__LILI_ALIGNMENT) double gbx[__LILIP_GATHER_BLOCK];
+  alignas(__LILI_ALIGNMENT) double gby[__LILIP_GATHER_BLOCK];
+  alignas(__LILI_ALIGNMENT) double gbz[__LILIP_GATHER_BLOCK];
 
-  double rx, ry;
   double ex, ey, ez, bx, by, bz;
   double um, vm, wm, up, vp, wp;
   double temp;
@@ -64,52 +269,258 @@ void ParticleMover::MoveBoris2D(Particles& particles,
   const double crx = fields.size.nx / fields.size.lx;
   const double cry = fields.size.ny / fields.size.ly;
 
-  // Loop over the particles
-  for (int i = 0; i < npar; ++i) {
-    // Get the particle position
-    rx = (x[i] - fields.size.x0) * crx;
-    ry = (y[i] - fields.size.y0) * cry;
-
-    ex = qmhdt * fields.ex.BilinearInterpolation(rx, ry);
-    ey = qmhdt * fields.ey.BilinearInterpolation(rx, ry);
-    ez = qmhdt * fields.ez.BilinearInterpolation(rx, ry);
-
-    bx = qmhdt * fields.bx.BilinearInterpolation(rx, ry);
-    by = qmhdt * fields.by.BilinearInterpolation(rx, ry);
-    bz = qmhdt * fields.bz.BilinearInterpolation(rx, ry);
-
-    // First half acceleration
-    um = u[i] + ex;
-    vm = v[i] + ey;
-    wm = w[i] + ez;
-
-    // First half of the rotation
-    temp = 1.0 / std::sqrt(1.0 + um * um + vm * vm + wm * wm);
-    bx *= temp;
-    by *= temp;
-    bz *= temp;
-
-    temp = 2.0 / (1.0 + bx * bx + by * by + bz * bz);
-    up = (um + vm * bz - wm * by) * temp;
-    vp = (vm + wm * bx - um * bz) * temp;
-    wp = (wm + um * by - vm * bx) * temp;
-
-    // Second half acceleration
-    um = um + ex + vp * bz - wp * by;
-    vm = vm + ey + wp * bx - up * bz;
-    wm = wm + ez + up * by - vp * bx;
-
-    // Advance position
-    temp = 1.0 / std::sqrt(1.0 + um * um + vm * vm + wm * wm);
-    x[i] += dt_ * um * temp;
-    y[i] += dt_ * vm * temp;
-    z[i] += dt_ * wm * temp;
-
-    // Update velocity
-    u[i] = um;
-    v[i] = vm;
-    w[i] = wm;
+  // Domain bounds for the boundary policy
+  const mesh::MeshSize& ms = fields.size;
+  const double xmax = ms.x0 + ms.lx;
+  const double ymax = ms.y0 + ms.ly;
+  const double zmax = ms.z0 + ms.lz;
+  int ncross = 0;
+
+  // Loop over the blocks of particles
+  for (int ib = lo; ib < hi; ib += __LILIP_GATHER_BLOCK) {
+    const int nb = std::min(__LILIP_GATHER_BLOCK, hi - ib);
+
+    for (int i_step = 0; i_step < n_step; ++i_step) {
+      // Get the particle positions
+      for (int l = 0; l < nb; ++l) {
+        rx[l] = (x[ib + l] - fields.size.x0) * crx;
+        ry[l] = (y[ib + l] - fields.size.y0) * cry;
+        if constexpr (BP == BoundaryPolicy::Absorb) {
+          // Absorbed particles are outside of the mesh
+          if (HasStatus(status[ib + l], ParticleStatus::Out)) {
+            rx[l] = 0.0;
+            ry[l] = 0.0;
+          }
+        }
+      }
+
+      fields.GatherEB<2, Order>(rx, ry, nullptr, nb, gex, gey, gez, gbx, gby,
+                                gbz);
+
+      for (int l = 0; l < nb; ++l) {
+        const int i = ib + l;
+
+        // Absorbed particles are not moved anymore
+        if constexpr (BP == BoundaryPolicy::Absorb) {
+          if (HasStatus(status[i], ParticleStatus::Out)) {
+            continue;
+          }
+        }
+
+        ex = qmhdt * gex[l];
+        ey = qmhdt * gey[l];
+        ez = qmhdt * gez[l];
+
+        bx = qmhdt * gbx[l];
+        by = qmhdt * gby[l];
+        bz = qmhdt * gbz[l];
+
+        // First half acceleration
+        um = u[i] + ex;
+        vm = v[i] + ey;
+        wm = w[i] + ez;
+
+        // First half of the rotation
+        temp = 1.0 / std::sqrt(1.0 + um * um + vm * vm + wm * wm);
+        bx *= temp;
+        by *= temp;
+        bz *= temp;
+
+        temp = 2.0 / (1.0 + bx * bx + by * by + bz * bz);
+        up = (um + vm * bz - wm * by) * temp;
+        vp = (vm + wm * bx - um * bz) * temp;
+        wp = (wm + um * by - vm * bx) * temp;
+
+        // Second half acceleration
+        um = um + ex + vp * bz - wp * by;
+        vm = vm + ey + wp * bx - up * bz;
+        wm = wm + ez + up * by - vp * bx;
+
+        // Advance position
+        temp = 1.0 / std::sqrt(1.0 + um * um + vm * vm + wm * wm);
+        x[i] += dt_ * um * temp;
+        y[i] += dt_ * vm * temp;
+        z[i] += dt_ * wm * temp;
+
+        // Apply the boundary policy
+        const int cx = BoundaryAxis<BP>(x[i], ms.x0, xmax, ms.lx);
+        const int cy = BoundaryAxis<BP>(y[i], ms.y0, ymax, ms.ly);
+        BoundaryAxis<BoundaryPolicy::Periodic>(z[i], ms.z0, zmax, ms.lz);
+        ncross += BoundaryStatus<BP>(status[i], cx, cy);
+
+        // Update velocity
+        u[i] = um;
+        v[i] = vm;
+        w[i] = wm;
+      }
+    }
   }
+
+  return ncross;
+}
+
+/**
+ * @brief Move particles stored with the cell index and in-cell offset using
+ * the Boris particle mover
+ *
+ * @param[in] particles
+ * Particles object in the input::PPosLayout::Cell layout
+ * @param[in] fields
+ * Fields object
+ * @param[in] lo
+ * First particle index to move
+ * @param[in] hi
+ * Last particle index (exclusive) to move
+ * @param[in] n_step
+ * Number of time steps to move each particle
+ * @return int
+ * Number of boundary crossings of the X or Y boundaries
+ * @details
+ * The mesh coordinate is the sum of the cell index and the offset, so the
+ * fields are interpolated without any coordinate transform. The displacement
+ * is scaled to the grid unit and the particle moves to a new cell when the
+ * offset leaves \f$ [0, 1) \f$. The boundary policy only acts on the cell
+ * index. The blocks and the steps are batched as in MoveBoris2D.
+ */
+template <BoundaryPolicy BP, int Order>
+int ParticleMover::MoveBoris2DCell(Particles& particles,
+                                   const mesh::Fields& fields, int lo, int hi,
+                                   int n_step) {
+  // Initialize variables
+  const double qmhdt = particles.q() * dt_ / (2.0 * particles.m());
+
+  // Get the particle information
+  Particles::RealX* __restrict__ x = particles.x();
+  Particles::RealX* __restrict__ y = particles.y();
+  Particles::RealX* __restrict__ z = particles.z();
+
+  int* __restrict__ ix = particles.ix();
+  int* __restrict__ iy = particles.iy();
+  int* __restrict__ iz = particles.iz();
+
+  Particles::RealU* __restrict__ u = particles.u();
+  Particles::RealU* __restrict__ v = particles.v();
+  Particles::RealU* __restrict__ w = particles.w();
+
+  ParticleStatus* __restrict__ status = particles.status();
+
+  // Gathered fields of a block
+  alignas(__LILI_ALIGNMENT) double rx[__LILIP_GATHER_BLOCK];
+  alignas(__LILI_ALIGNMENT) double ry[__LILIP_GATHER_BLOCK];
+  alignas(__LILI_ALIGNMENT) double gex[__LILIP_GATHER_BLOCK];
+  alignas(__LILI_ALIGNMENT) double gey[__LILIP_GATHER_BLOCK];
+  alignas(__LILI_ALIGNMENT) double gez[__LILIP_GATHER_BLOCK];
+  alignas(__LILI_ALIGNMENT) double gbx[__LILIP_GATHER_BLOCK];
+  alignas(__LILI_ALIGNMENT) double gby[__LILIP_GATHER_BLOCK];
+  alignas(__LILI_ALIGNMENT) double gbz[__LILIP_GATHER_BLOCK];
+
+  double sx, sy, sz;
+  double ex, ey, ez, bx, by, bz;
+  double um, vm, wm, up, vp, wp;
+  double temp, shift;
+
+  // Displacement in the grid unit
+  const double dtx = dt_ * particles.grid().nx / particles.grid().lx;
+  const double dty = dt_ * particles.grid().ny / particles.grid().ly;
+  const double dtz = dt_ * particles.grid().nz / particles.grid().lz;
+
+  // Number of cells for the boundary policy
+  const int nx = particles.grid().nx;
+  const int ny = particles.grid().ny;
+  const int nz = particles.grid().nz;
+  int ncross = 0;
+
+  // Loop over the blocks of particles
+  for (int ib = lo; ib < hi; ib += __LILIP_GATHER_BLOCK) {
+    const int nb = std::min(__LILIP_GATHER_BLOCK, hi - ib);
+
+    for (int i_step = 0; i_step < n_step; ++i_step) {
+      // Get the particle positions in the mesh coordinate
+      for (int l = 0; l < nb; ++l) {
+        rx[l] = ix[ib + l] + static_cast<double>(x[ib + l]);
+        ry[l] = iy[ib + l] + static_cast<double>(y[ib + l]);
+        if constexpr (BP == BoundaryPolicy::Absorb) {
+          // Absorbed particles are outside of the mesh
+          if (HasStatus(status[ib + l], ParticleStatus::Out)) {
+            rx[l] = 0.0;
+            ry[l] = 0.0;
+          }
+        }
+      }
+
+      fields.GatherEB<2, Order>(rx, ry, nullptr, nb, gex, gey, gez, gbx, gby,
+                                gbz);
+
+      for (int l = 0; l < nb; ++l) {
+        const int i = ib + l;
+
+        // Absorbed particles are not moved anymore
+        if constexpr (BP == BoundaryPolicy::Absorb) {
+          if (HasStatus(status[i], ParticleStatus::Out)) {
+            continue;
+          }
+        }
+
+        ex = qmhdt * gex[l];
+        ey = qmhdt * gey[l];
+        ez = qmhdt * gez[l];
+
+        bx = qmhdt * gbx[l];
+        by = qmhdt * gby[l];
+        bz = qmhdt * gbz[l];
+
+        // First half acceleration
+        um = u[i] + ex;
+        vm = v[i] + ey;
+        wm = w[i] + ez;
+
+        // First half of the rotation
+        temp = 1.0 / std::sqrt(1.0 + um * um + vm * vm + wm * wm);
+        bx *= temp;
+        by *= temp;
+        bz *= temp;
+
+        temp = 2.0 / (1.0 + bx * bx + by * by + bz * bz);
+        up = (um + vm * bz - wm * by) * temp;
+        vp = (vm + wm * bx - um * bz) * temp;
+        wp = (wm + um * by - vm * bx) * temp;
+
+        // Second half acceleration
+        um = um + ex + vp * bz - wp * by;
+        vm = vm + ey + wp * bx - up * bz;
+        wm = wm + ez + up * by - vp * bx;
+
+        // Advance the offset and move to the new cell
+        temp = 1.0 / std::sqrt(1.0 + um * um + vm * vm + wm * wm);
+        sx = x[i] + dtx * um * temp;
+        sy = y[i] + dty * vm * temp;
+        sz = z[i] + dtz * wm * temp;
+
+        shift = std::floor(sx);
+        ix[i] += static_cast<int>(shift);
+        x[i] = sx - shift;
+        shift = std::floor(sy);
+        iy[i] += static_cast<int>(shift);
+        y[i] = sy - shift;
+        shift = std::floor(sz);
+        iz[i] += static_cast<int>(shift);
+        z[i] = sz - shift;
+
+        // Apply the boundary policy
+        const int cx = BoundaryAxis<BP>(ix[i], 0, nx - 1, nx);
+        const int cy = BoundaryAxis<BP>(iy[i], 0, ny - 1, ny);
+        BoundaryAxis<BoundaryPolicy::Periodic>(iz[i], 0, nz - 1, nz);
+        ncross += BoundaryStatus<BP>(status[i], cx, cy);
+
+        // Update velocity
+        u[i] = um;
+        v[i] = vm;
+        w[i] = wm;
+      }
+    }
+  }
+
+  return ncross;
 }
 }  // namespace lili::particle
 
@@ -123,17 +534,108 @@ void TaskMoveParticlesFull::Initialize() {
       std::get<std::unique_ptr<mesh::Fields>>(sim_vars[SimVarType::EMFields])
           .get();
 
+  // Check the fields and build the fields cache
+  mover_.InitializeFields(*fields_ptr_, test_particle_, interleave_);
+
+  // Tracking needs the tracked particles to stay in memory
+  if (mover_.boundary() == particle::BoundaryPolicy::Absorb) {
+    for (const auto& input_particles : input_particles_) {
+      if (input_particles.n_track > 0) {
+        lili::lerr << "Particle tracking is not supported by the absorb "
+                   << "boundary: " << input_particles.name << std::endl;
+        lili::output::LiliExit(2);
+      }
+    }
+  }
+
+  // Batching the time steps needs static fields
+  if (batch_ > 1) {
+    if (!test_particle_) {
+      lili::lerr << "Batched particle mover needs a test particle input"
+                 << std::endl;
+      lili::output::LiliExit(2);
+    }
+
+    // Keep the tracking output on the batch boundaries
+    for (const auto& input_particles : input_particles_) {
+      if (input_particles.n_track > 0 && input_particles.dl_track > 0) {
+        batch_ = std::gcd(batch_, input_particles.dl_track);
+      }
+    }
+
+    // The crossing flags only keep the last step of a batch
+    if (batch_ > 1 &&
+        mover_.boundary() == particle::BoundaryPolicy::Label) {
+      lili::lerr << "Batched particle mover does not support the label "
+                 << "boundary" << std::endl;
+      lili::output::LiliExit(2);
+    }
+    lili::lout << "Batched mover : " << batch_ << " steps" << std::endl;
+  }
+
   // Call the base class Initialize
   Task::Initialize();
 }
 void TaskMoveParticlesFull::Execute() {
-  // Loop through all species
-  for (auto& particles : *particles_ptr_) {
-    // Move particles
-    (mover_.Move)(particles, *fields_ptr_);
+  // Move every particle the steps of the batch at once
+  if (batch_ > 1) {
+    if (i_run() % batch_ == 0) {
+      const int n_step = std::min(batch_, n_loop_ - i_run());
+      for (auto& particles : *particles_ptr_) {
+        if (mover_.Move(particles, *fields_ptr_, n_step) > 0 &&
+            mover_.boundary() == particle::BoundaryPolicy::Absorb) {
+          particles.CleanOut();
+        }
+      }
+    }
+
+    // Call the base class Execute
+    Task::Execute();
+    return;
+  }
+
+  // Get the particle tiles, if any
+  std::vector<particle::ParticleTiles>* tiles = nullptr;
+  auto it = sim_vars.find(SimVarType::ParticleTilesVector);
+  if (it != sim_vars.end()) {
+    tiles =
+        std::get<std::unique_ptr<std::vector<particle::ParticleTiles>>>(
+            it->second)
+            .get();
+  }
+
+  // Check whether all of the species can be moved together, tile by tile
+  const int nspecies = particles_ptr_->size();
+  bool fused = (tiles != nullptr && nspecies > 1);
+  for (int i = 0; fused && i < nspecies; ++i) {
+    fused = (*tiles)[i].Covers((*particles_ptr_)[i].npar()) &&
+            (*tiles)[i].Matches((*tiles)[0]);
+  }
+
+  // Move particles and apply the boundary policy in the same sweep
+  std::vector<int> ncross(nspecies);
+  if (fused) {
+    ncross = mover_.Move(*particles_ptr_, *fields_ptr_, *tiles);
+  } else {
+    for (int i = 0; i < nspecies; ++i) {
+      auto& particles = (*particles_ptr_)[i];
+
+      // Tile by tile if the tiles are up to date
+      if (tiles != nullptr && (*tiles)[i].Covers(particles.npar())) {
+        ncross[i] = mover_.Move(particles, *fields_ptr_, (*tiles)[i]);
+      } else {
+        ncross[i] = mover_.Move(particles, *fields_ptr_);
+      }
+    }
+  }
 
-    // Temporary boundary
-    particle::PeriodicBoundaryParticles(particles, fields_ptr_->size);
+  // Remove the absorbed particles
+  if (mover_.boundary() == particle::BoundaryPolicy::Absorb) {
+    for (int i = 0; i < nspecies; ++i) {
+      if (ncross[i] > 0) {
+        (*particles_ptr_)[i].CleanOut();
+      }
+    }
   }
 
   // Call the base class Execute
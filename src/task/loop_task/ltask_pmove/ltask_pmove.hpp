@@ -4,11 +4,23 @@
  */
 #pragma once
 
+#include <string>
+#include <vector>
+
 #include "fields.hpp"
 #include "input.hpp"
 #include "particle.hpp"
+#include "particle_tiles.hpp"
+#include "shape.hpp"
 #include "task.hpp"
 
+#ifndef __LILIP_GATHER_BLOCK
+/**
+ * @brief Number of particles per field gather of the particle mover
+ */
+#define __LILIP_GATHER_BLOCK 64
+#endif
+
 namespace lili::particle {
 /**
  * @brief Enumeration class for the particle mover type
@@ -19,6 +31,48 @@ typedef enum : int {
   Boris3D   ///< Boris 3D particle mover */
 } ParticleMoverType;
 
+/**
+ * @brief Enumeration class for the particle boundary policy of the mover
+ *
+ * @details
+ * The boundary policy is applied inside the particle mover loop, right after
+ * the position update, so that each step touches the particle data once.
+ *
+ * BoundaryPolicy::Label wraps the positions as well: a labelled particle is
+ * still moved by the next steps of a multi-step Move, or by the next Move if
+ * no exchange runs in between, and an unwrapped position would gather the
+ * fields outside of the ghost cells. The wrap is undone exactly by the
+ * crossing flags, the position in the frame of the neighbour is the wrapped
+ * one shifted by CrossOffset times the domain length along each axis, and on
+ * a periodic domain that is its own neighbour the wrapped position is final.
+ */
+enum class BoundaryPolicy {
+  Periodic,  ///< Wrap the particles periodically
+  Label,     ///< Wrap periodically and set the crossing flags for the exchange
+  Absorb     ///< Flag the crossing particles as ParticleStatus::Out
+};
+
+/**
+ * @brief Function to convert a string to BoundaryPolicy
+ *
+ * @param[in] policy String representation of the boundary policy
+ * @param[out] boundary_policy Boundary policy
+ * @return bool Whether the string is a valid boundary policy
+ */
+inline bool StringToBoundaryPolicy(const std::string& policy,
+                                   BoundaryPolicy& boundary_policy) {
+  if (policy == "periodic") {
+    boundary_policy = BoundaryPolicy::Periodic;
+  } else if (policy == "label") {
+    boundary_policy = BoundaryPolicy::Label;
+  } else if (policy == "absorb") {
+    boundary_policy = BoundaryPolicy::Absorb;
+  } else {
+    return false;
+  }
+  return true;
+}
+
 /**
  * @brief Class for Particle mover
  */
@@ -27,6 +81,8 @@ class ParticleMover {
   // Constructor
   ParticleMover()
       : type_(ParticleMoverType::None),
+        boundary_(BoundaryPolicy::Periodic),
+        shape_(mesh::ShapeOrder::CIC),
         dt_(1.0),
         cache_(nullptr),
         Move_(nullptr) {};
@@ -39,15 +95,104 @@ class ParticleMover {
   };
 
   // Initialize Mover
-  void InitializeMover(const input::InputLoop& input);
+  void InitializeMover(const input::InputLoop& input,
+                       BoundaryPolicy boundary = BoundaryPolicy::Periodic,
+                       mesh::ShapeOrder shape = mesh::ShapeOrder::CIC);
+
+  /**
+   * @brief Check whether the ghost cells of a mesh fit the shape function
+   *
+   * @param size Mesh size of the fields
+   * @return bool Whether every resolved axis has at least
+   * mesh::ShapeGhost ghost cells
+   */
+  bool FitsGhost(const mesh::MeshSize& size) const {
+    const int ng = mesh::ShapeGhost(shape_);
+    return size.ngx >= ng && (size.dim < 2 || size.ngy >= ng) &&
+           (size.dim < 3 || size.ngz >= ng);
+  };
+
+  /**
+   * @brief Check the fields for the mover and build the fields cache
+   *
+   * @param fields Fields object
+   * @param test_particle Whether the fields are static
+   * @param interleave Whether to gather from the interleaved fields cache
+   * @details
+   * Exits if the ghost cells do not fit the shape function, or if the
+   * interleaved cache is asked for fields that are not static, since the
+   * cache is only built here.
+   */
+  void InitializeFields(mesh::Fields& fields, bool test_particle,
+                        bool interleave) const;
 
-  // Move particles
-  void Move(Particles& particles, const mesh::Fields& fields) {
-    (this->*Move_)(particles, fields);
+  /**
+   * @brief Move particles and apply the boundary policy
+   *
+   * @param particles Particles object
+   * @param fields Fields object
+   * @return int Number of particles crossing a boundary, always 0 for the
+   * BoundaryPolicy::Periodic policy
+   */
+  int Move(Particles& particles, const mesh::Fields& fields) {
+    return (this->*Move_)(particles, fields, 0, particles.npar(), 1);
   };
 
+  /**
+   * @brief Move particles several time steps in static fields
+   *
+   * @param particles Particles object
+   * @param fields Fields object, constant over the `n_step` steps
+   * @param n_step Number of time steps
+   * @return int Number of boundary crossings over all of the steps
+   * @details
+   * The loop order is inverted with respect to calling Move `n_step` times:
+   * each block of `__LILIP_GATHER_BLOCK` particles is moved all of the
+   * steps while it stays in cache, so the particle data is read from memory
+   * once per call instead of once per step. The particles are split between
+   * the OpenMP threads. The result is the same as `n_step` calls of Move,
+   * except that the crossing flags of BoundaryPolicy::Label only keep the
+   * last step, so the tasks do not batch the steps with that policy.
+   */
+  int Move(Particles& particles, const mesh::Fields& fields, int n_step);
+
+  /**
+   * @brief Move particles tile by tile
+   *
+   * @param particles Particles object sorted with ParticleTiles::Build
+   * @param fields Fields object
+   * @param tiles Tiles of the particles
+   * @return int Number of particles crossing a boundary
+   * @details
+   * Each tile is moved by a single OpenMP thread so that its field stencil
+   * stays in the thread cache.
+   */
+  int Move(Particles& particles, const mesh::Fields& fields,
+           const ParticleTiles& tiles);
+
+  /**
+   * @brief Move all species together, tile by tile
+   *
+   * @param particles Particles of each species, sorted with
+   * ParticleTiles::Build
+   * @param fields Fields object
+   * @param tiles Tiles of each species, all matching each other
+   * @return std::vector<int> Number of particles crossing a boundary for
+   * each species
+   * @details
+   * Every species of a tile is moved before moving to the next tile, so that
+   * the field stencil of the tile is loaded into cache once for all of the
+   * species instead of once per species. The charge to mass ratio of each
+   * species is taken from its Particles object.
+   */
+  std::vector<int> Move(std::vector<Particles>& particles,
+                        const mesh::Fields& fields,
+                        const std::vector<ParticleTiles>& tiles);
+
   // Getter
   constexpr ParticleMoverType type() const { return type_; };
+  constexpr BoundaryPolicy boundary() const { return boundary_; };
+  constexpr mesh::ShapeOrder shape() const { return shape_; };
 
   constexpr double dt() const { return dt_; };
   constexpr double* cache() const { return cache_; };
@@ -58,45 +203,102 @@ class ParticleMover {
 
  private:
   ParticleMoverType type_;
+  BoundaryPolicy boundary_;
+  mesh::ShapeOrder shape_;
 
   double dt_;
   double* cache_;
 
   // Function pointer to actual Mover used
-  void (ParticleMover::*Move_)(Particles& particles,
-                               const mesh::Fields& fields);
+  int (ParticleMover::*Move_)(Particles& particles,
+                              const mesh::Fields& fields, int lo, int hi,
+                              int n_step);
 
   // Different Movers
-  void MoveNone(Particles& particles, const mesh::Fields& fields) {
+  int MoveNone(Particles& particles, const mesh::Fields& fields, int lo,
+               int hi, int n_step) {
     std::cout << "Moving particles using no particle mover" << std::endl;
 
-    int npar = particles.npar();
+    (void)particles;
+    (void)n_step;
     double* __restrict__ ex = fields.ex.data();
     double sum = 0.;
-    for (int i = 0; i < npar; ++i) {
+    for (int i = lo; i < hi; ++i) {
       sum += ex[i];
     }
+    return 0;
   };
-  void MoveBoris2D(Particles& particles, const mesh::Fields& fields);
+  template <BoundaryPolicy BP>
+  void SetMoveBoris2D();
+  template <BoundaryPolicy BP, int Order>
+  int MoveBoris2D(Particles& particles, const mesh::Fields& fields, int lo,
+                  int hi, int n_step);
+  template <BoundaryPolicy BP, int Order>
+  int MoveBoris2DCell(Particles& particles, const mesh::Fields& fields, int lo,
+                      int hi, int n_step);
 };
 }  // namespace lili::particle
 
 namespace lili::task {
 /**
  * @brief Task class to move particles a full time step
+ *
+ * @details
+ * The boundary policy is set with the `boundary` key of the task, one of
+ * `periodic` (default), `label`, or `absorb`:
+ * ```json
+ * "move_particles": {
+ *   "type": "full",
+ *   "boundary": "periodic"
+ * }
+ * ```
+ * Absorbed particles are removed at the end of the step, so the `absorb`
+ * boundary does not support particle tracking.
+ *
+ * For a test particle input, the fields are static and the time steps can be
+ * batched: with a `frequency` of \f$ K > 1 \f$, the task moves every particle
+ * \f$ K \f$ steps at once every \f$ K \f$ loop iterations, with the particle
+ * loop outside of the time loop. The batch is reduced to divide the
+ * `dl_track` of the tracked species, so that tracking still samples the
+ * particles at the right time step. The other loop tasks see the particles
+ * at the end of the batch. The `label` boundary is rejected with batching,
+ * since the crossing flags would only keep the last step of a batch.
+ *
+ * With `"interleave": true`, the fields are gathered from the interleaved
+ * cache of mesh::Fields, built once at initialization. The cache is not
+ * rebuilt, so it needs the static fields of a test particle input.
+ *
+ * The particle shape function is set with the `shape` key, one of `ngp`,
+ * `cic` (default), `tsc`, or `pqs`. The mesh needs mesh::ShapeGhost ghost
+ * cells on each side for the chosen shape.
  */
 class TaskMoveParticlesFull : public Task {
  public:
   // Constructor
-  TaskMoveParticlesFull() : Task(TaskType::MoveParticlesFull), mover_() {
+  TaskMoveParticlesFull()
+      : Task(TaskType::MoveParticlesFull),
+        mover_(),
+        batch_(1),
+        n_loop_(0),
+        test_particle_(false),
+        interleave_(false) {
     set_name("MoveParticlesFull");
   }
 
-  TaskMoveParticlesFull(const input::Input& input)
-      : Task(TaskType::MoveParticlesFull), mover_() {
+  TaskMoveParticlesFull(const input::Input& input,
+                        const input::InputLoopTask& input_task,
+                        particle::BoundaryPolicy boundary =
+                            particle::BoundaryPolicy::Periodic)
+      : Task(TaskType::MoveParticlesFull),
+        mover_(),
+        batch_(input_task.frequency),
+        n_loop_(input.loop().n_loop),
+        test_particle_(input.input_type() == input::InputType::TestParticle),
+        interleave_(input_task.interleave),
+        input_particles_(input.particles()) {
     set_name("MoveParticlesFull");
 
-    mover_.InitializeMover(input.loop());
+    mover_.InitializeMover(input.loop(), boundary, input_task.shape);
   }
 
   /**
@@ -105,12 +307,17 @@ class TaskMoveParticlesFull : public Task {
   void Initialize() override;
 
   /**
-   * @brief Move particles a full time step
+   * @brief Move particles a full time step, or a batch of time steps
    */
   void Execute() override;
 
  private:
   particle::ParticleMover mover_;  ///< Particle mover object
+  int batch_;                      ///< Number of time steps moved at once
+  int n_loop_;                     ///< Number of loop iterations
+  bool test_particle_;             ///< Whether the fields are static
+  bool interleave_;                ///< Whether to build the fields cache
+  std::vector<input::InputParticles> input_particles_;  ///< Species inputs
   /**
    * @brief Pointer to the simulation Particles vector
    */
@@ -0,0 +1,184 @@
+/**
+ * @file ltask_pooc.cpp
+ * @brief Source file for the out-of-core particle mover routines
+ */
+#include "ltask_pooc.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <future>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+
+#include "parameter.hpp"
+
+namespace lili::particle {
+ParticleStore::ParticleStore()
+    : prefix_(""),
+      chunk_(__LILIP_OOC_CHUNK),
+      q_(1.0),
+      m_(1.0),
+      layout_(input::PPosLayout::Physical),
+      grid_() {}
+
+ParticleStore::ParticleStore(const std::string& prefix, int chunk,
+                             const Particles& particles)
+    : prefix_(prefix),
+      chunk_(std::max(chunk, 1)),
+      q_(particles.q()),
+      m_(particles.m()),
+      layout_(particles.layout()),
+      grid_(particles.grid()) {}
+
+long ParticleStore::npar() const {
+  return std::accumulate(npar_.begin(), npar_.end(), 0L);
+}
+
+std::string ParticleStore::ChunkFile(int ichunk) const {
+  std::stringstream ss;
+  ss << prefix_ << "_" << std::setw(5) << std::setfill('0') << ichunk
+     << ".h5";
+  return ss.str();
+}
+
+void ParticleStore::Seed(const char* file_name) {
+  npar_.clear();
+  StreamParticles<Particles::RealX, Particles::RealU>(
+      file_name, 0, -1, chunk_, [this](Particles& particles, long) {
+        SaveParticles(particles, ChunkFile(npar_.size()).c_str());
+        npar_.push_back(particles.npar());
+      });
+}
+
+Particles ParticleStore::Load(int ichunk) const {
+  Particles particles = LoadParticles(ChunkFile(ichunk).c_str());
+  particles.q() = q_;
+  particles.m() = m_;
+  if (layout_ == input::PPosLayout::Cell) {
+    particles.SetLayout(input::PPosLayout::Cell, grid_);
+  }
+  return particles;
+}
+
+void ParticleStore::Update(const std::function<void(Particles&)>& update,
+                           ParticleWriter& writer) {
+  if (npar_.empty()) {
+    return;
+  }
+
+  // Read the first chunk in the background
+  std::future<Particles> next =
+      std::async(std::launch::async, [this]() { return Load(0); });
+
+  for (int ichunk = 0; ichunk < nchunk(); ++ichunk) {
+    std::vector<Particles> particles;
+    particles.push_back(next.get());
+
+    // Prefetch the next chunk while the current one is updated
+    if (ichunk + 1 < nchunk()) {
+      next = std::async(std::launch::async,
+                        [this, ichunk]() { return Load(ichunk + 1); });
+    }
+
+    update(particles[0]);
+    npar_[ichunk] = particles[0].npar();
+
+    // Write the chunk back in the background, waiting for the previous one
+    writer.Write(std::move(particles), {ChunkFile(ichunk)});
+  }
+
+  writer.Wait();
+}
+}  // namespace lili::particle
+
+namespace lili::task {
+void TaskMoveParticlesOutOfCore::Initialize() {
+  // Get the particles and fields from the simulation variables
+  particles_ptr_ = std::get<std::unique_ptr<std::vector<particle::Particles>>>(
+                       sim_vars[SimVarType::ParticlesVector])
+                       .get();
+  fields_ptr_ =
+      std::get<std::unique_ptr<mesh::Fields>>(sim_vars[SimVarType::EMFields])
+          .get();
+
+  // The chunks are moved several steps at once, so the fields must be static
+  if (!test_particle_) {
+    lili::lerr << "Out-of-core particle mover needs a test particle input"
+               << std::endl;
+    lili::output::LiliExit(2);
+  }
+
+  // The crossing flags only keep the last step of a pass
+  if (frequency_ > 1 &&
+      mover_.boundary() == particle::BoundaryPolicy::Label) {
+    lili::lerr << "Out-of-core particle mover does not support the label "
+               << "boundary" << std::endl;
+    lili::output::LiliExit(2);
+  }
+
+  // Check the fields and build the fields cache
+  mover_.InitializeFields(*fields_ptr_, test_particle_, interleave_);
+
+  // Seed the store of each species
+  stores_.clear();
+  for (std::size_t i = 0; i < particles_ptr_->size(); ++i) {
+    auto& particles = (*particles_ptr_)[i];
+    const std::string& name = input_particles_[i].name;
+    if (input_particles_[i].n_track > 0) {
+      lili::lerr << "Particle tracking is not supported by the out-of-core "
+                 << "mover: " << name << std::endl;
+      lili::output::LiliExit(2);
+    }
+
+    const std::string prefix =
+        std::filesystem::path(lili::output_folder) /
+        ("ooc_" + name + "_" + std::to_string(lili::rank));
+    stores_.emplace_back(prefix, chunk_, particles);
+
+    auto it = files_.find(name);
+    if (it != files_.end()) {
+      stores_[i].Seed(it->second.c_str());
+    } else {
+      // Go through a file to split the particles initialized in memory
+      const std::string seed = prefix + "_seed.h5";
+      particle::SaveParticles(particles, seed.c_str());
+      stores_[i].Seed(seed.c_str());
+      std::filesystem::remove(seed);
+    }
+
+    // Release the particles in memory
+    particles.npar() = 0;
+    particles.resize(0);
+
+    lili::lout << "Out-of-core   : " << name << ", " << stores_[i].npar()
+               << " particles in " << stores_[i].nchunk() << " chunks"
+               << std::endl;
+  }
+
+  // Call the base class Initialize
+  Task::Initialize();
+}
+
+void TaskMoveParticlesOutOfCore::Execute() {
+  // Move every chunk the steps until the next pass
+  if (i_run() % frequency_ == 0) {
+    const int n_step = std::min(frequency_, n_loop_ - i_run());
+    const bool absorb =
+        (mover_.boundary() == particle::BoundaryPolicy::Absorb);
+
+    for (auto& store : stores_) {
+      store.Update(
+          [&](particle::Particles& particles) {
+            if (mover_.Move(particles, *fields_ptr_, n_step) > 0 && absorb) {
+              particles.CleanOut();
+            }
+          },
+          writer_);
+    }
+  }
+
+  // Call the base class Execute
+  Task::Execute();
+}
+}  // namespace lili::task
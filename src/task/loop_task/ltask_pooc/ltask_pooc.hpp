@@ -0,0 +1,205 @@
+/**
+ * @file ltask_pooc.hpp
+ * @brief Header file for the out-of-core particle mover routines
+ */
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "fields.hpp"
+#include "input.hpp"
+#include "ltask_pmove.hpp"
+#include "ltask_psave.hpp"
+#include "particle.hpp"
+#include "task.hpp"
+
+#ifndef __LILIP_OOC_CHUNK
+/**
+ * @brief Default number of particles per chunk of the out-of-core mover
+ */
+#define __LILIP_OOC_CHUNK 1048576
+#endif
+
+namespace lili::particle {
+/**
+ * @brief Class to store the particles of a species on disk in chunks
+ *
+ * @details
+ * The particles are stored in one particle file per chunk of at most `chunk`
+ * particles, named `<prefix>_<chunk>.h5`. Update streams the chunks through
+ * memory: the next chunk is read in the background while the current chunk
+ * is processed, and the processed chunk is written back in the background by
+ * a ParticleWriter. At most three chunks are in memory at once, independently
+ * of the number of particles in the store.
+ *
+ * The chunk files do not store the charge, the mass, or the position layout
+ * of the particles, which are restored when a chunk is read.
+ */
+class ParticleStore {
+ public:
+  // Constructor
+  ParticleStore();
+
+  /**
+   * @brief Constructor for an empty store of a species
+   *
+   * @param prefix Prefix of the chunk files
+   * @param chunk Maximum number of particles per chunk
+   * @param particles Particles of the species, for the charge, the mass, and
+   * the position layout
+   */
+  ParticleStore(const std::string& prefix, int chunk,
+                const Particles& particles);
+
+  // Getters
+  /// @cond GETTERS
+  int nchunk() const { return npar_.size(); }
+  int chunk() const { return chunk_; }
+  long npar() const;
+  /// @endcond
+
+  /**
+   * @brief Name of the file of a chunk
+   *
+   * @param ichunk Index of the chunk
+   */
+  std::string ChunkFile(int ichunk) const;
+
+  /**
+   * @brief Split a particle file into the chunks of the store
+   *
+   * @param file_name Name of the particle file
+   * @details
+   * The file is streamed with StreamParticles, so it can be larger than the
+   * memory.
+   */
+  void Seed(const char* file_name);
+
+  /**
+   * @brief Read a chunk of the store
+   *
+   * @param ichunk Index of the chunk
+   * @return Particles Particles of the chunk
+   */
+  Particles Load(int ichunk) const;
+
+  /**
+   * @brief Update every chunk of the store in place
+   *
+   * @param update Function applied to the particles of each chunk
+   * @param writer Writer for the updated chunks
+   * @details
+   * The update may remove particles from a chunk. The function returns once
+   * all of the chunks are written back.
+   */
+  void Update(const std::function<void(Particles&)>& update,
+              ParticleWriter& writer);
+
+ private:
+  std::string prefix_;  ///< Prefix of the chunk files
+  int chunk_;           ///< Maximum number of particles per chunk
+  double q_, m_;        ///< Charge and mass of the species
+  input::PPosLayout layout_;  ///< Position layout of the species
+  mesh::MeshSize grid_;       ///< Mesh for the cell layout
+  std::vector<long> npar_;    ///< Number of particles of each chunk
+};
+}  // namespace lili::particle
+
+namespace lili::task {
+/**
+ * @brief Task class to move test particles that do not fit in memory
+ *
+ * @details
+ * Test particles do not interact, so they can be moved in independent chunks
+ * against the static fields. The particles of each species are kept in a
+ * particle::ParticleStore in the output folder, and every `frequency` loop
+ * iterations each chunk is moved `frequency` steps at once. The task is set in
+ * the input file loop tasks as:
+ * ```json
+ * "move_particles": {
+ *   "type": "out_of_core",
+ *   "frequency": 1000,
+ *   "chunk": 1048576,
+ *   "boundary": "periodic",
+ *   "files": {
+ *     "electrons": "dump/particles_electrons_0_00010.h5"
+ *   }
+ * }
+ * ```
+ * The store of a species listed in `files` is seeded from the particle file,
+ * otherwise from the particles initialized in memory, which are then
+ * released. The moved particles are left in the chunk files
+ * `ooc_<species>_<rank>_<chunk>.h5`. The task needs a test particle input,
+ * and rejects the `label` boundary when `frequency` is above 1 as
+ * TaskMoveParticlesFull does for batching.
+ * Particle tracking is not supported, and neither are the `sort_particles`
+ * and `save_particles` tasks, which would only see the released particles.
+ * With `"interleave": true`, the fields are gathered from the interleaved
+ * cache of mesh::Fields. The `shape` key sets the particle shape function as
+ * in TaskMoveParticlesFull.
+ */
+class TaskMoveParticlesOutOfCore : public Task {
+ public:
+  // Constructor
+  TaskMoveParticlesOutOfCore()
+      : Task(TaskType::MoveParticlesOutOfCore),
+        mover_(),
+        frequency_(1),
+        chunk_(__LILIP_OOC_CHUNK),
+        n_loop_(0),
+        test_particle_(false),
+        interleave_(false) {
+    set_name("MoveParticlesOutOfCore");
+  }
+
+  TaskMoveParticlesOutOfCore(const input::Input& input,
+                             const input::InputLoopTask& input_task,
+                             particle::BoundaryPolicy boundary)
+      : Task(TaskType::MoveParticlesOutOfCore),
+        mover_(),
+        frequency_(input_task.frequency),
+        chunk_(input_task.chunk > 0 ? input_task.chunk : __LILIP_OOC_CHUNK),
+        n_loop_(input.loop().n_loop),
+        test_particle_(input.input_type() == input::InputType::TestParticle),
+        interleave_(input_task.interleave),
+        files_(input_task.files),
+        input_particles_(input.particles()) {
+    set_name("MoveParticlesOutOfCore");
+
+    mover_.InitializeMover(input.loop(), boundary, input_task.shape);
+  }
+
+  /**
+   * @brief Seed the particle store of each species
+   */
+  void Initialize() override;
+
+  /**
+   * @brief Move every chunk `frequency` steps every `frequency` loop
+   * iterations
+   */
+  void Execute() override;
+
+ private:
+  particle::ParticleMover mover_;  ///< Particle mover object
+  int frequency_;       ///< Number of loop iterations between chunk passes
+  int chunk_;           ///< Number of particles per chunk
+  int n_loop_;          ///< Number of loop iterations of the simulation
+  bool test_particle_;  ///< Whether the fields are static
+  bool interleave_;     ///< Whether to build the fields cache
+  std::map<std::string, std::string> files_;  ///< Seed file of each species
+  std::vector<input::InputParticles> input_particles_;  ///< Species inputs
+  std::vector<particle::ParticleStore> stores_;  ///< Store of each species
+  particle::ParticleWriter writer_;  ///< Background chunk writer
+  /**
+   * @brief Pointer to the simulation Particles vector
+   */
+  std::vector<particle::Particles>* particles_ptr_;
+  /**
+   * @brief Pointer to the simulation Fields vector
+   */
+  mesh::Fields* fields_ptr_;
+};
+}  // namespace lili::task
@@ -0,0 +1,118 @@
+/**
+ * @file ltask_psave.cpp
+ * @brief Source file for the particle saving routines
+ */
+#include "ltask_psave.hpp"
+
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+
+#include "parameter.hpp"
+
+namespace lili::particle {
+void ParticleWriter::Write(const std::vector<Particles>& particles,
+                           const std::vector<std::string>& file_names) {
+  // Wait for the previous snapshot to be written
+  Wait();
+
+  // Copy the live particles into the staging buffers
+  staging_.resize(particles.size());
+  for (std::size_t i = 0; i < particles.size(); ++i) {
+    staging_[i].CopyFrom(particles[i]);
+  }
+  file_names_ = file_names;
+
+  Start();
+}
+
+void ParticleWriter::Write(std::vector<Particles>&& particles,
+                           const std::vector<std::string>& file_names) {
+  // Wait for the previous snapshot to be written
+  Wait();
+
+  // Take the particles as the staging buffers
+  staging_ = std::move(particles);
+  file_names_ = file_names;
+
+  Start();
+}
+
+void ParticleWriter::Start() {
+  // Write the staging buffers in the background
+  busy_ = true;
+  thread_ = std::thread([this]() {
+    for (std::size_t i = 0; i < staging_.size(); ++i) {
+      SaveParticles(staging_[i], file_names_[i].c_str());
+    }
+    busy_ = false;
+  });
+}
+
+void ParticleWriter::Wait() {
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+}  // namespace lili::particle
+
+namespace lili::task {
+void TaskSaveParticles::Initialize() {
+  // Get the particles from the simulation variables
+  particles_ptr_ = std::get<std::unique_ptr<std::vector<particle::Particles>>>(
+                       sim_vars[SimVarType::ParticlesVector])
+                       .get();
+
+  // The collective write needs every rank to call it from the loop
+  if (collective_ && async_) {
+    lili::lerr << "Collective particle saving needs the sync type"
+               << std::endl;
+    lili::output::LiliExit(2);
+  }
+
+  // Call the base class Initialize
+  Task::Initialize();
+}
+
+void TaskSaveParticles::Execute() {
+  // Save every frequency_ iterations
+  if (i_run() % frequency_ == 0) {
+    std::stringstream ss;
+    ss << std::setw(5) << std::setfill('0') << i_save_;
+
+    // Single file for all ranks in the collective mode
+    const std::string rank =
+        collective_ ? "" : std::to_string(lili::rank) + "_";
+    std::vector<std::string> file_names;
+    for (std::size_t i = 0; i < particles_ptr_->size(); ++i) {
+      file_names.push_back(std::filesystem::path(lili::output_folder) /
+                           ("particles_" + names_[i] + "_" + rank + ss.str() +
+                            ".h5"));
+    }
+
+    if (async_) {
+      writer_.Write(*particles_ptr_, file_names);
+    } else if (collective_) {
+      for (std::size_t i = 0; i < particles_ptr_->size(); ++i) {
+        particle::SaveParticles((*particles_ptr_)[i], file_names[i].c_str(),
+                                MPI_COMM_WORLD);
+      }
+    } else {
+      for (std::size_t i = 0; i < particles_ptr_->size(); ++i) {
+        particle::SaveParticles((*particles_ptr_)[i], file_names[i].c_str());
+      }
+    }
+    ++i_save_;
+  }
+
+  // Call the base class Execute
+  Task::Execute();
+}
+
+void TaskSaveParticles::CleanUp() {
+  writer_.Wait();
+
+  // Call the base class CleanUp
+  Task::CleanUp();
+}
+}  // namespace lili::task
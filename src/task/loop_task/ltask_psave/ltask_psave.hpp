@@ -0,0 +1,169 @@
+/**
+ * @file ltask_psave.hpp
+ * @brief Header file for the particle saving routines
+ */
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "input.hpp"
+#include "particle.hpp"
+#include "task.hpp"
+
+namespace lili::particle {
+/**
+ * @brief Class to save snapshots of the particles from a background thread
+ *
+ * @details
+ * Write copies the live particles of every species into staging buffers and
+ * returns, while a background thread saves the staging buffers with
+ * SaveParticles. The simulation keeps moving the particles during the write.
+ * The staging buffers are kept between snapshots, so the copy does not
+ * allocate once they are large enough.
+ *
+ * There is one staging buffer per species. If the previous snapshot is still
+ * being written, Write first waits for it to finish, which bounds both the
+ * memory used and the number of writes in flight to one.
+ */
+class ParticleWriter {
+ public:
+  // Constructor
+  ParticleWriter() : busy_(false) {}
+  ParticleWriter(const ParticleWriter&) = delete;
+  ParticleWriter& operator=(const ParticleWriter&) = delete;
+
+  // Destructor
+  ~ParticleWriter() { Wait(); }
+
+  /**
+   * @brief Start writing a snapshot of the particles
+   *
+   * @param particles Particles of each species
+   * @param file_names Name of the file of each species
+   */
+  void Write(const std::vector<Particles>& particles,
+             const std::vector<std::string>& file_names);
+
+  /**
+   * @brief Start writing particles that are not needed anymore
+   *
+   * @param particles Particles of each species, moved to the staging buffers
+   * @param file_names Name of the file of each species
+   * @details
+   * The particles are moved instead of copied, which avoids the copy when
+   * the caller does not keep the particles, e.g. chunks streamed from disk.
+   */
+  void Write(std::vector<Particles>&& particles,
+             const std::vector<std::string>& file_names);
+
+  /**
+   * @brief Wait for the snapshot in flight to be written
+   */
+  void Wait();
+
+  /**
+   * @brief Check whether a snapshot is being written
+   */
+  bool busy() const { return busy_; }
+
+ private:
+  /**
+   * @brief Start the I/O thread writing the staging buffers
+   */
+  void Start();
+
+  std::vector<Particles> staging_;       ///< Staging buffer of each species
+  std::vector<std::string> file_names_;  ///< File name of each species
+  std::thread thread_;                   ///< Background I/O thread
+  std::atomic<bool> busy_;               ///< Whether a snapshot is in flight
+};
+}  // namespace lili::particle
+
+namespace lili::task {
+/**
+ * @brief Task class to save the particles periodically
+ *
+ * @details
+ * The type is `sync` to write the particles in the loop, or `async` to write
+ * them with a particle::ParticleWriter in the background. The task is set in
+ * the input file loop tasks as:
+ * ```json
+ * "save_particles": {
+ *   "type": "async",
+ *   "frequency": 1000
+ * }
+ * ```
+ * Each rank writes one file per species and snapshot, named
+ * `particles_<species>_<rank>_<snapshot>.h5` in the output folder. The files
+ * can be read back with particle::LoadParticles.
+ *
+ * With `"collective": true`, all of the ranks write their particles into a
+ * single file per species and snapshot, `particles_<species>_<snapshot>.h5`,
+ * with the collective SaveParticles over `MPI_COMM_WORLD`. The collective
+ * write is only supported with the `sync` type, since MPI is not initialized
+ * for calls from the background thread.
+ */
+class TaskSaveParticles : public Task {
+ public:
+  // Constructor
+  TaskSaveParticles()
+      : Task(TaskType::SaveParticles),
+        async_(false),
+        collective_(false),
+        frequency_(1),
+        i_save_(0) {
+    set_name("SaveParticles");
+  }
+
+  TaskSaveParticles(const input::Input& input,
+                    const input::InputLoopTask& input_task)
+      : Task(TaskType::SaveParticles),
+        async_(input_task.type == "async"),
+        collective_(input_task.collective),
+        frequency_(input_task.frequency),
+        i_save_(0) {
+    set_name("SaveParticles");
+
+    for (auto& input_particles : input.particles()) {
+      names_.push_back(input_particles.name);
+    }
+  }
+
+  /**
+   * @brief Initialize internal variables
+   */
+  void Initialize() override;
+
+  /**
+   * @brief Save the particles every `frequency` loop iterations
+   */
+  void Execute() override;
+
+  /**
+   * @brief Wait for the last snapshot to be written
+   */
+  void CleanUp() override;
+
+  // Getters
+  /// @cond GETTERS
+  bool async() const { return async_; }
+  bool collective() const { return collective_; }
+  int frequency() const { return frequency_; }
+  /// @endcond
+
+ private:
+  bool async_;      ///< Whether to write in the background
+  bool collective_;  ///< Whether to write a single file for all ranks
+  int frequency_;   ///< Number of loop iterations between saves
+  int i_save_;      ///< Index of the next snapshot
+  std::vector<std::string> names_;   ///< Name of each species
+  particle::ParticleWriter writer_;  ///< Background particle writer
+  /**
+   * @brief Pointer to the simulation Particles vector
+   */
+  std::vector<particle::Particles>* particles_ptr_;
+};
+}  // namespace lili::task
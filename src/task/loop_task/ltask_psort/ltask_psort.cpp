@@ -0,0 +1,112 @@
+/**
+ * @file ltask_psort.cpp
+ * @brief Source file for the particle sorting routines
+ */
+#include "ltask_psort.hpp"
+
+#include <memory>
+#include <vector>
+
+#include "parameter.hpp"
+
+namespace lili::particle {
+void CellKey(const Particles& particles, const mesh::MeshSize& mesh_size,
+             mesh::CellOrder order, uint64_t* key) {
+  const int npar = particles.npar();
+
+  // The cell index is stored in the cell layout
+  if (particles.layout() == input::PPosLayout::Cell) {
+    const int* __restrict__ ix = particles.ix();
+    const int* __restrict__ iy = particles.iy();
+    const int* __restrict__ iz = particles.iz();
+
+#pragma omp parallel for if (npar >= __LILIP_DEFAULT_OMPSIZE)
+    for (int i = 0; i < npar; ++i) {
+      const int jx = std::clamp(ix[i], 0, mesh_size.nx - 1);
+      const int jy = std::clamp(iy[i], 0, mesh_size.ny - 1);
+      const int jz = std::clamp(iz[i], 0, mesh_size.nz - 1);
+
+      key[i] = mesh::CellOrderKey(order, jx, jy, jz, mesh_size.nx,
+                                  mesh_size.ny, mesh_size.nz);
+    }
+    return;
+  }
+
+  const Particles::RealX* __restrict__ x = particles.x();
+  const Particles::RealX* __restrict__ y = particles.y();
+  const Particles::RealX* __restrict__ z = particles.z();
+
+  const double crx = mesh_size.nx / mesh_size.lx;
+  const double cry = mesh_size.ny / mesh_size.ly;
+  const double crz = mesh_size.nz / mesh_size.lz;
+
+#pragma omp parallel for if (npar >= __LILIP_DEFAULT_OMPSIZE)
+  for (int i = 0; i < npar; ++i) {
+    int ix = static_cast<int>((x[i] - mesh_size.x0) * crx);
+    int iy = static_cast<int>((y[i] - mesh_size.y0) * cry);
+    int iz = static_cast<int>((z[i] - mesh_size.z0) * crz);
+
+    ix = std::clamp(ix, 0, mesh_size.nx - 1);
+    iy = std::clamp(iy, 0, mesh_size.ny - 1);
+    iz = std::clamp(iz, 0, mesh_size.nz - 1);
+
+    key[i] = mesh::CellOrderKey(order, ix, iy, iz, mesh_size.nx, mesh_size.ny,
+                                mesh_size.nz);
+  }
+}
+
+void SortParticles(Particles& particles, const mesh::MeshSize& mesh_size,
+                   mesh::CellOrder order) {
+  // Calculate the sort key
+  std::vector<uint64_t> key(particles.npar());
+  CellKey(particles, mesh_size, order, key.data());
+
+  // Sort the particles
+  SortParticlesByKey(particles, key.data());
+}
+}  // namespace lili::particle
+
+namespace lili::task {
+void TaskSortParticles::Initialize() {
+  // Get the particles and fields from the simulation variables
+  particles_ptr_ = std::get<std::unique_ptr<std::vector<particle::Particles>>>(
+                       sim_vars[SimVarType::ParticlesVector])
+                       .get();
+  fields_ptr_ =
+      std::get<std::unique_ptr<mesh::Fields>>(sim_vars[SimVarType::EMFields])
+          .get();
+
+  // Create the particle tiles of each species
+  tiles_ptr_ = nullptr;
+  if (!tile_.empty()) {
+    auto tiles = std::make_unique<std::vector<particle::ParticleTiles>>();
+    tiles->reserve(particles_ptr_->size());
+    for (std::size_t i = 0; i < particles_ptr_->size(); ++i) {
+      tiles->emplace_back(fields_ptr_->size, tile_[0], tile_[1], tile_[2],
+                          order_);
+    }
+    tiles_ptr_ = tiles.get();
+    sim_vars[SimVarType::ParticleTilesVector] = std::move(tiles);
+  }
+
+  // Call the base class Initialize
+  Task::Initialize();
+}
+
+void TaskSortParticles::Execute() {
+  // Sort every frequency_ iterations
+  if (i_run() % frequency_ == 0) {
+    for (std::size_t i = 0; i < particles_ptr_->size(); ++i) {
+      if (tiles_ptr_ != nullptr) {
+        (*tiles_ptr_)[i].Build((*particles_ptr_)[i]);
+      } else {
+        particle::SortParticles((*particles_ptr_)[i], fields_ptr_->size,
+                                order_);
+      }
+    }
+  }
+
+  // Call the base class Execute
+  Task::Execute();
+}
+}  // namespace lili::task
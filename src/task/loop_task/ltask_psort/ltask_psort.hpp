@@ -0,0 +1,119 @@
+/**
+ * @file ltask_psort.hpp
+ * @brief Header file for the particle sorting routines
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "fields.hpp"
+#include "input.hpp"
+#include "particle.hpp"
+#include "particle_tiles.hpp"
+#include "sfc.hpp"
+#include "task.hpp"
+
+namespace lili::particle {
+/**
+ * @brief Function to calculate the cell ordering key of each particle
+ *
+ * @param[in] particles Particles object
+ * @param[in] mesh_size Mesh size of the domain
+ * @param[in] order Cell ordering
+ * @param[out] key Cell ordering key of each particle
+ * @details
+ * The key is calculated with mesh::CellOrderKey from the cell index used by
+ * `Mesh::operator()(i, j, k)`. Particles outside of the domain are assigned
+ * to the closest cell. In the input::PPosLayout::Cell layout the stored cell
+ * index is used directly.
+ */
+void CellKey(const Particles& particles, const mesh::MeshSize& mesh_size,
+             mesh::CellOrder order, uint64_t* key);
+
+/**
+ * @brief Function to sort particles based on their cell location
+ *
+ * @param particles Particles object
+ * @param mesh_size Mesh size of the domain
+ * @param order Cell ordering
+ */
+void SortParticles(Particles& particles, const mesh::MeshSize& mesh_size,
+                   mesh::CellOrder order);
+}  // namespace lili::particle
+
+namespace lili::task {
+/**
+ * @brief Task class to sort particles periodically
+ *
+ * @details
+ * Sorting particles by cell keeps the field gathers of the particle movers
+ * cache friendly. The type is one of the mesh::CellOrder, `cell` for the
+ * row-major Mesh ordering, `morton`, or `hilbert`. Space-filling curves keep
+ * the full 3D interpolation stencil of nearby particles in cache. The task is
+ * set in the input file loop tasks as:
+ * ```json
+ * "sort_particles": {
+ *   "type": "cell",
+ *   "frequency": 20,
+ *   "tile": [32, 32, 1]
+ * }
+ * ```
+ *
+ * The optional `tile` sets the number of cells per particle::ParticleTiles
+ * tile. The particles are then sorted by tile, and the tiles are stored in the
+ * simulation variables for the particle mover.
+ */
+class TaskSortParticles : public Task {
+ public:
+  // Constructor
+  TaskSortParticles()
+      : Task(TaskType::SortParticles),
+        order_(mesh::CellOrder::RowMajor),
+        frequency_(1) {
+    set_name("SortParticles");
+  }
+
+  TaskSortParticles(const input::InputLoopTask& input_task)
+      : Task(TaskType::SortParticles),
+        order_(mesh::CellOrder::RowMajor),
+        frequency_(input_task.frequency),
+        tile_(input_task.tile) {
+    set_name("SortParticles");
+    mesh::StringToCellOrder(input_task.type, order_);
+  }
+
+  /**
+   * @brief Initialize internal variables
+   */
+  void Initialize() override;
+
+  /**
+   * @brief Sort particles every `frequency` loop iterations
+   */
+  void Execute() override;
+
+  // Getters
+  /// @cond GETTERS
+  mesh::CellOrder order() const { return order_; }
+  int frequency() const { return frequency_; }
+  /// @endcond
+
+ private:
+  mesh::CellOrder order_;  ///< Sort order
+  int frequency_;  ///< Number of loop iterations between sorting
+  std::vector<int> tile_;  ///< Number of cells per tile, empty for no tiles
+  /**
+   * @brief Pointer to the simulation Particles vector
+   */
+  std::vector<particle::Particles>* particles_ptr_;
+  /**
+   * @brief Pointer to the simulation Fields vector
+   */
+  mesh::Fields* fields_ptr_;
+  /**
+   * @brief Pointer to the ParticleTiles vector, `nullptr` for no tiles
+   */
+  std::vector<particle::ParticleTiles>* tiles_ptr_;
+};
+}  // namespace lili::task
@@ -8,6 +8,9 @@
 #include "itask_fields.hpp"
 #include "itask_particles.hpp"
 #include "ltask_pmove.hpp"
+#include "ltask_pooc.hpp"
+#include "ltask_psave.hpp"
+#include "ltask_psort.hpp"
 
 namespace lili::task {
 // Initialize global variables
@@ -16,7 +19,8 @@ std::vector<std::unique_ptr<Task>> loop_task_list;
 std::map<SimVarType,
          std::variant<std::unique_ptr<mesh::Fields>,
                       std::unique_ptr<std::vector<particle::Particles>>,
-                      std::unique_ptr<std::vector<particle::TrackParticles>>>>
+                      std::unique_ptr<std::vector<particle::TrackParticles>>,
+                      std::unique_ptr<std::vector<particle::ParticleTiles>>>>
     sim_vars;
 
 void InitializeTask(Task* task) {
@@ -34,6 +38,15 @@ void InitializeTask(Task* task) {
     case TaskType::MoveParticlesFull:
       dynamic_cast<TaskMoveParticlesFull*>(task)->Initialize();
       break;
+    case TaskType::MoveParticlesOutOfCore:
+      dynamic_cast<TaskMoveParticlesOutOfCore*>(task)->Initialize();
+      break;
+    case TaskType::SortParticles:
+      dynamic_cast<TaskSortParticles*>(task)->Initialize();
+      break;
+    case TaskType::SaveParticles:
+      dynamic_cast<TaskSaveParticles*>(task)->Initialize();
+      break;
     default:
       task->Initialize();
       break;
@@ -52,6 +65,15 @@ void ExecuteTask(Task* task) {
     case TaskType::MoveParticlesFull:
       dynamic_cast<TaskMoveParticlesFull*>(task)->Execute();
       break;
+    case TaskType::MoveParticlesOutOfCore:
+      dynamic_cast<TaskMoveParticlesOutOfCore*>(task)->Execute();
+      break;
+    case TaskType::SortParticles:
+      dynamic_cast<TaskSortParticles*>(task)->Execute();
+      break;
+    case TaskType::SaveParticles:
+      dynamic_cast<TaskSaveParticles*>(task)->Execute();
+      break;
     default:
       break;
   }
@@ -63,6 +85,9 @@ void CleanUpTask(Task* task) {
     case TaskType::InitParticles:
       dynamic_cast<TaskInitParticles*>(task)->CleanUp();
       break;
+    case TaskType::SaveParticles:
+      dynamic_cast<TaskSaveParticles*>(task)->CleanUp();
+      break;
     default:
       task->CleanUp();
       break;
@@ -89,10 +114,31 @@ void ParseTaskList(input::Input& input) {
 
     // Switch based on the task name
     if (task.name == "move_particles") {
+      // Check the type and the boundary policy of the task
+      particle::BoundaryPolicy boundary;
+      const bool valid =
+          particle::StringToBoundaryPolicy(task.boundary, boundary);
+      if (valid && task.type == "full") {
+        loop_task_list.push_back(
+            std::make_unique<TaskMoveParticlesFull>(input, task, boundary));
+        task_found = true;
+      } else if (valid && task.type == "out_of_core") {
+        loop_task_list.push_back(std::make_unique<TaskMoveParticlesOutOfCore>(
+            input, task, boundary));
+        task_found = true;
+      }
+    } else if (task.name == "sort_particles") {
       // Check the type of the task
-      if (task.type == "full") {
+      mesh::CellOrder order;
+      if (mesh::StringToCellOrder(task.type, order)) {
+        loop_task_list.push_back(std::make_unique<TaskSortParticles>(task));
+        task_found = true;
+      }
+    } else if (task.name == "save_particles") {
+      // Check the type of the task
+      if (task.type == "sync" || task.type == "async") {
         loop_task_list.push_back(
-            std::make_unique<TaskMoveParticlesFull>(input));
+            std::make_unique<TaskSaveParticles>(input, task));
         task_found = true;
       }
     }
@@ -102,6 +148,20 @@ void ParseTaskList(input::Input& input) {
       lili::lout << "Task not found: " << task.name << std::endl;
     }
   }
+
+  // The out-of-core mover releases the particles in memory
+  bool out_of_core = false, in_memory = false;
+  for (auto& task : loop_task_list) {
+    out_of_core |= (task->type() == TaskType::MoveParticlesOutOfCore);
+    in_memory |= (task->type() == TaskType::SortParticles ||
+                  task->type() == TaskType::SaveParticles);
+  }
+  if (out_of_core && in_memory) {
+    lili::lerr << "Out-of-core particle mover does not support the "
+               << "sort_particles and save_particles tasks" << std::endl;
+    lili::output::LiliExit(2);
+  }
+
   // Print the task list
   lili::lout << "=========== Task information ===========" << std::endl;
   lili::lout << "Default tasks : " << std::endl;
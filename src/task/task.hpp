@@ -14,6 +14,7 @@
 #include "input.hpp"
 #include "parameter.hpp"
 #include "particle.hpp"
+#include "particle_tiles.hpp"
 #include "track_particle.hpp"
 
 /**
@@ -25,11 +26,14 @@ namespace lili::task {
  * @brief Enumeration for task type
  */
 enum class TaskType {
-  Base,               ///< Base task
-  CreateOutput,       ///< Task to create output folder
-  InitParticles,      ///< Task to initialize particles
-  InitFields,         ///< Task to initialize fields
-  MoveParticlesFull,  ///< Task to move particles a full step
+  Base,                    ///< Base task
+  CreateOutput,            ///< Task to create output folder
+  InitParticles,           ///< Task to initialize particles
+  InitFields,              ///< Task to initialize fields
+  MoveParticlesFull,       ///< Task to move particles a full step
+  MoveParticlesOutOfCore,  ///< Task to move particles stored on disk
+  SortParticles,           ///< Task to sort particles
+  SaveParticles,           ///< Task to save particles
 };
 
 /**
@@ -39,6 +43,7 @@ enum class SimVarType {
   EMFields,              ///< Electromagnetic Field object
   ParticlesVector,       ///< Vector of Particles object
   TrackParticlesVector,  ///< Vector of TrackParticles object
+  ParticleTilesVector,   ///< Vector of ParticleTiles object
 };
 
 /**
@@ -177,7 +182,8 @@ extern std::map<
     task::SimVarType,
     std::variant<std::unique_ptr<mesh::Fields>,
                  std::unique_ptr<std::vector<particle::Particles>>,
-                 std::unique_ptr<std::vector<particle::TrackParticles>>>>
+                 std::unique_ptr<std::vector<particle::TrackParticles>>,
+                 std::unique_ptr<std::vector<particle::ParticleTiles>>>>
     sim_vars;
 
 /**
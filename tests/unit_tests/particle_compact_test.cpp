@@ -0,0 +1,116 @@
+/**
+ * @file particle_compact_test.cpp
+ * @brief Unit tests for the stable compaction of the Particles class
+ */
+
+#include <gtest/gtest.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <vector>
+
+#include "particle.hpp"
+
+namespace {
+using lili::particle::Particles;
+using lili::particle::ParticleStatus;
+
+// Enough particles for the OpenMP path of the compaction
+constexpr int kNpar = 3 * __LILIP_DEFAULT_OMPSIZE + 17;
+
+/**
+ * @brief Particles with mixed statuses, every third particle is Out and
+ * every fifth particle is Tracked
+ */
+Particles MixedParticles() {
+  Particles particles(kNpar);
+  for (int i = 0; i < kNpar; ++i) {
+    particles.id(i) = i;
+    particles.x(i) = i;
+    particles.u(i) = -i;
+    particles.status(i) = ParticleStatus::In;
+    if (i % 3 == 0) {
+      particles.status(i) |= ParticleStatus::Out;
+    }
+    if (i % 5 == 0) {
+      particles.status(i) |= ParticleStatus::Tracked;
+    }
+  }
+  return particles;
+}
+
+/**
+ * @brief Serial reference of a stable compaction
+ *
+ * @param particles Particles to compact
+ * @param status Status flags of the selected particles
+ * @param select Whether to return the selected or the other particles
+ */
+std::vector<unsigned long> SerialIds(const Particles& particles,
+                                     ParticleStatus status, bool select) {
+  std::vector<unsigned long> ids;
+  for (int i = 0; i < particles.npar(); ++i) {
+    if (lili::particle::HasStatus(particles.status(i), status) == select) {
+      ids.push_back(particles.id(i));
+    }
+  }
+  return ids;
+}
+
+/**
+ * @brief Check the ids and the data columns against the reference ids
+ */
+void ExpectIds(const Particles& particles,
+               const std::vector<unsigned long>& ids) {
+  ASSERT_EQ(particles.npar(), static_cast<int>(ids.size()));
+  for (int i = 0; i < particles.npar(); ++i) {
+    ASSERT_EQ(particles.id(i), ids[i]) << "at " << i;
+    ASSERT_EQ(particles.x(i), ids[i]) << "at " << i;
+    ASSERT_EQ(particles.u(i), -static_cast<double>(ids[i])) << "at " << i;
+  }
+}
+}  // namespace
+
+TEST(ParticleCompactTest, CleanOutKeepsOrder) {
+  Particles particles = MixedParticles();
+  const auto ids = SerialIds(particles, ParticleStatus::Out, false);
+
+  particles.CleanOut();
+  ExpectIds(particles, ids);
+}
+
+TEST(ParticleCompactTest, SelectParticlesKeepsOrder) {
+  Particles particles = MixedParticles();
+  const auto selected = SerialIds(particles, ParticleStatus::Tracked, true);
+  const auto kept = SerialIds(particles, ParticleStatus::Tracked, false);
+
+  Particles output;
+  lili::particle::SelectParticles(particles, output, ParticleStatus::Tracked,
+                                  true);
+  ExpectIds(output, selected);
+  ExpectIds(particles, kept);
+}
+
+#ifdef _OPENMP
+TEST(ParticleCompactTest, CleanOutSmallerTeam) {
+  Particles particles = MixedParticles();
+  const auto ids = SerialIds(particles, ParticleStatus::Out, false);
+
+  // A nested region gets a team of one thread while more are requested
+  const int max_threads = omp_get_max_threads();
+  const int max_levels = omp_get_max_active_levels();
+  omp_set_num_threads(4);
+  omp_set_max_active_levels(1);
+#pragma omp parallel num_threads(2)
+  {
+#pragma omp single
+    particles.CleanOut();
+  }
+  omp_set_max_active_levels(max_levels);
+  omp_set_num_threads(max_threads);
+
+  ExpectIds(particles, ids);
+}
+#endif
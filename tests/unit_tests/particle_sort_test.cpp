@@ -0,0 +1,98 @@
+/**
+ * @file particle_sort_test.cpp
+ * @brief Unit tests for the key sorting of the Particles class
+ */
+
+#include <gtest/gtest.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "particle.hpp"
+
+namespace {
+using lili::particle::ColumnType;
+using lili::particle::Particles;
+using lili::particle::ParticleStatus;
+
+/**
+ * @brief Sort particles with random keys and check every column against a
+ * stable sort of the keys
+ *
+ * @param npar Number of particles
+ * @param key_max Largest key, small values give many equal keys
+ * @param nthread Number of OpenMP threads of the sort
+ */
+void ExpectStableSort(int npar, uint64_t key_max, int nthread = 1) {
+  Particles particles(npar);
+  const int iw = particles.AddColumn("weight", ColumnType::Float32);
+  const int ic = particles.AddColumn("cell", ColumnType::Int32);
+
+  std::mt19937_64 gen(npar);
+  std::uniform_int_distribution<uint64_t> dist(0, key_max);
+  std::vector<uint64_t> key(npar);
+  for (int i = 0; i < npar; ++i) {
+    key[i] = dist(gen);
+    particles.id(i) = i;
+    particles.status(i) = (i % 7 == 0) ? ParticleStatus::Tracked
+                                       : ParticleStatus::In;
+    particles.x(i) = i + 0.25;
+    particles.y(i) = i + 0.5;
+    particles.z(i) = i + 0.75;
+    particles.u(i) = -i;
+    particles.v(i) = 2 * i;
+    particles.w(i) = 3 * i;
+    particles.column<float>(iw)[i] = 0.5f * i;
+    particles.column<int32_t>(ic)[i] = -i;
+  }
+
+  // Reference stable permutation
+  std::vector<int> perm(npar);
+  std::iota(perm.begin(), perm.end(), 0);
+  std::stable_sort(perm.begin(), perm.end(),
+                   [&key](int a, int b) { return key[a] < key[b]; });
+
+#ifdef _OPENMP
+  const int max_threads = omp_get_max_threads();
+  omp_set_num_threads(nthread);
+#else
+  (void)nthread;
+#endif
+  lili::particle::SortParticlesByKey(particles, key.data());
+#ifdef _OPENMP
+  omp_set_num_threads(max_threads);
+#endif
+
+  ASSERT_EQ(particles.npar(), npar);
+  for (int i = 0; i < npar; ++i) {
+    const int p = perm[i];
+    ASSERT_EQ(particles.id(i), static_cast<unsigned long>(p)) << "at " << i;
+    ASSERT_EQ(particles.status(i), (p % 7 == 0) ? ParticleStatus::Tracked
+                                                : ParticleStatus::In);
+    ASSERT_EQ(particles.x(i), p + 0.25);
+    ASSERT_EQ(particles.y(i), p + 0.5);
+    ASSERT_EQ(particles.z(i), p + 0.75);
+    ASSERT_EQ(particles.u(i), -p);
+    ASSERT_EQ(particles.v(i), 2 * p);
+    ASSERT_EQ(particles.w(i), 3 * p);
+    ASSERT_EQ(particles.column<float>(iw)[i], 0.5f * p);
+    ASSERT_EQ(particles.column<int32_t>(ic)[i], -p);
+  }
+}
+}  // namespace
+
+TEST(ParticleSortTest, SmallKeys) { ExpectStableSort(1000, 15); }
+
+TEST(ParticleSortTest, SmallKeysParallel) {
+  ExpectStableSort(4 * __LILIP_DEFAULT_OMPSIZE + 3, 255, 4);
+}
+
+TEST(ParticleSortTest, LargeKeysParallel) {
+  ExpectStableSort(4 * __LILIP_DEFAULT_OMPSIZE + 3, ~uint64_t(0), 3);
+}
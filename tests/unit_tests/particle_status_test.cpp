@@ -0,0 +1,130 @@
+/**
+ * @file particle_status_test.cpp
+ * @brief Unit tests for the particle status flags and the legacy status files
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <filesystem>
+#include <string>
+
+#include "hdf5.h"
+#include "particle.hpp"
+
+namespace {
+using lili::particle::Particles;
+using lili::particle::ParticleStatus;
+
+/**
+ * @brief Names of the legacy status enumeration, in the order of its values
+ */
+const char* kLegacyNames[] = {
+    "Out",     "In",      "Tracked", "X0",      "X1",      "Y0",
+    "Y1",      "Z0",      "Z1",      "X0Y0",    "X0Y1",    "X1Y0",
+    "X1Y1",    "X0Z0",    "X0Z1",    "X1Z0",    "X1Z1",    "Y0Z0",
+    "Y0Z1",    "Y1Z0",    "Y1Z1",    "X0Y0Z0",  "X0Y0Z1",  "X0Y1Z0",
+    "X0Y1Z1",  "X1Y0Z0",  "X1Y0Z1",  "X1Y1Z0",  "X1Y1Z1",  "TX0",
+    "TX1",     "TY0",     "TY1",     "TZ0",     "TZ1",     "TX0Y0",
+    "TX0Y1",   "TX1Y0",   "TX1Y1",   "TX0Z0",   "TX0Z1",   "TX1Z0",
+    "TX1Z1",   "TY0Z0",   "TY0Z1",   "TY1Z0",   "TY1Z1",   "TX0Y0Z0",
+    "TX0Y0Z1", "TX0Y1Z0", "TX0Y1Z1", "TX1Y0Z0", "TX1Y0Z1", "TX1Y1Z0",
+    "TX1Y1Z1"};
+constexpr int kNlegacy = sizeof(kLegacyNames) / sizeof(kLegacyNames[0]);
+
+/**
+ * @brief Flags of a legacy status from its name
+ */
+ParticleStatus LegacyFlags(const std::string& name) {
+  if (name == "Out") {
+    return ParticleStatus::Out;
+  } else if (name == "In") {
+    return ParticleStatus::In;
+  } else if (name == "Tracked") {
+    return ParticleStatus::Tracked;
+  }
+
+  ParticleStatus status = ParticleStatus::In;
+  std::size_t i = 0;
+  if (name[0] == 'T') {
+    status |= ParticleStatus::Tracked;
+    ++i;
+  }
+  const ParticleStatus cross[3][2] = {
+      {ParticleStatus::X0, ParticleStatus::X1},
+      {ParticleStatus::Y0, ParticleStatus::Y1},
+      {ParticleStatus::Z0, ParticleStatus::Z1}};
+  for (; i + 1 < name.size(); i += 2) {
+    status |= cross[name[i] - 'X'][name[i + 1] - '0'];
+  }
+  return status;
+}
+
+/**
+ * @brief Temporary file name for the test
+ */
+std::string TempFile(const std::string& name) {
+  return (std::filesystem::temp_directory_path() /
+          ("lili_" + name + "_" + std::to_string(::getpid()) + ".h5"))
+      .string();
+}
+}  // namespace
+
+TEST(ParticleStatusTest, LegacyTable) {
+  ASSERT_EQ(kNlegacy, __LILIP_LEGACY_NSTATUS);
+  for (int v = 0; v < kNlegacy; ++v) {
+    ParticleStatus status;
+    ASSERT_TRUE(lili::particle::LegacyStatus(v, status));
+    EXPECT_EQ(status, LegacyFlags(kLegacyNames[v])) << kLegacyNames[v];
+  }
+
+  ParticleStatus status;
+  EXPECT_FALSE(lili::particle::LegacyStatus(kNlegacy, status));
+}
+
+TEST(ParticleStatusTest, LegacyFile) {
+  // Write the legacy values, then drop the format attribute
+  Particles particles(kNlegacy);
+  for (int i = 0; i < kNlegacy; ++i) {
+    particles.id(i) = i;
+    particles.status(i) = static_cast<ParticleStatus>(i);
+  }
+  const std::string file_name = TempFile("legacy_status");
+  lili::particle::SaveParticles(particles, file_name.c_str());
+
+  hid_t file_id = H5Fopen(file_name.c_str(), H5F_ACC_RDWR, H5P_DEFAULT);
+  ASSERT_GE(file_id, 0);
+  ASSERT_GE(H5Adelete(file_id, "status_format"), 0);
+  H5Fclose(file_id);
+
+  Particles loaded = lili::particle::LoadParticles(file_name.c_str());
+  std::filesystem::remove(file_name);
+
+  ASSERT_EQ(loaded.npar(), kNlegacy);
+  for (int i = 0; i < kNlegacy; ++i) {
+    EXPECT_EQ(loaded.id(i), static_cast<unsigned long>(i));
+    EXPECT_EQ(loaded.status(i), LegacyFlags(kLegacyNames[i]))
+        << kLegacyNames[i];
+  }
+}
+
+TEST(ParticleStatusTest, FlagsFileUnchanged) {
+  // Every flag combination, including the values of the legacy range
+  const int npar = 256;
+  Particles particles(npar);
+  for (int i = 0; i < npar; ++i) {
+    particles.id(i) = i;
+    particles.status(i) = static_cast<ParticleStatus>(i);
+  }
+  const std::string file_name = TempFile("flags_status");
+  lili::particle::SaveParticles(particles, file_name.c_str());
+
+  Particles loaded = lili::particle::LoadParticles(file_name.c_str());
+  std::filesystem::remove(file_name);
+
+  ASSERT_EQ(loaded.npar(), npar);
+  for (int i = 0; i < npar; ++i) {
+    EXPECT_EQ(loaded.id(i), static_cast<unsigned long>(i));
+    EXPECT_EQ(loaded.status(i), static_cast<ParticleStatus>(i));
+  }
+}
@@ -0,0 +1,85 @@
+/**
+ * @file sfc_test.cpp
+ * @brief Unit tests for the space-filling curve cell ordering
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "sfc.hpp"
+
+namespace {
+/**
+ * @brief Naive Morton key, interleaving the bits one at a time
+ *
+ * @param idx Cell index in each axis
+ * @param nbit Number of bits per axis
+ */
+template <int D>
+uint64_t NaiveMortonKey(const uint32_t (&idx)[D], int nbit) {
+  uint64_t key = 0;
+  for (int b = 0; b < nbit; ++b) {
+    for (int d = 0; d < D; ++d) {
+      key |= static_cast<uint64_t>((idx[d] >> b) & 1) << (D * b + d);
+    }
+  }
+  return key;
+}
+
+/**
+ * @brief Check that a block order visits each block once, moving to a
+ * neighbour block at each step
+ */
+void ExpectHilbertBlocks(int nbx, int nby, int nbz) {
+  const std::vector<int> blocks = lili::mesh::CellOrderBlocks(
+      lili::mesh::CellOrder::Hilbert, nbx, nby, nbz);
+  ASSERT_EQ(static_cast<int>(blocks.size()), nbx * nby * nbz);
+
+  std::vector<int> seen(blocks.size(), 0);
+  for (int b : blocks) {
+    ASSERT_GE(b, 0);
+    ASSERT_LT(b, nbx * nby * nbz);
+    ++seen[b];
+  }
+  for (std::size_t b = 0; b < seen.size(); ++b) {
+    EXPECT_EQ(seen[b], 1) << "block " << b;
+  }
+
+  for (std::size_t n = 1; n < blocks.size(); ++n) {
+    const int a = blocks[n - 1];
+    const int b = blocks[n];
+    const int dist = std::abs(a % nbx - b % nbx) +
+                     std::abs(a / nbx % nby - b / nbx % nby) +
+                     std::abs(a / (nbx * nby) - b / (nbx * nby));
+    EXPECT_EQ(dist, 1) << "step " << n << ": " << a << " -> " << b;
+  }
+}
+}  // namespace
+
+TEST(SFCTest, MortonKey2D) {
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<uint32_t> dist;
+  for (int n = 0; n < 10000; ++n) {
+    const uint32_t idx[2] = {dist(gen), dist(gen)};
+    ASSERT_EQ(lili::mesh::MortonKey(idx[0], idx[1]), NaiveMortonKey(idx, 32))
+        << idx[0] << " " << idx[1];
+  }
+}
+
+TEST(SFCTest, MortonKey3D) {
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<uint32_t> dist(0, (1u << 21) - 1);
+  for (int n = 0; n < 10000; ++n) {
+    const uint32_t idx[3] = {dist(gen), dist(gen), dist(gen)};
+    ASSERT_EQ(lili::mesh::MortonKey(idx[0], idx[1], idx[2]),
+              NaiveMortonKey(idx, 21))
+        << idx[0] << " " << idx[1] << " " << idx[2];
+  }
+}
+
+TEST(SFCTest, HilbertBlocks2D) { ExpectHilbertBlocks(4, 4, 1); }
+
+TEST(SFCTest, HilbertBlocks3D) { ExpectHilbertBlocks(4, 4, 4); }